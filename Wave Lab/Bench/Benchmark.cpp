@@ -0,0 +1,101 @@
+//==============================================================================
+// Benchmark.cpp
+//==============================================================================
+
+#include "Benchmark.h"
+#include <numeric>
+
+String BenchmarkCase::getName() const {
+   if (waveform == WaveEngine::NumWaveformIds) {
+      return "getNextSample/" + String(WaveEngine::getInterpolationName(interpolation));
+   }
+   String name (WaveEngine::getWaveformName(waveform));
+   return (waveform >= WaveEngine::WT_START) ? name + "/" + WaveEngine::getInterpolationName(interpolation) : name;
+}
+
+var BenchmarkResult::toVar() const {
+   auto* object = new DynamicObject();
+   object->setProperty("generator", benchmarkCase.getName());
+   object->setProperty("blockSize", benchmarkCase.blockSize);
+   object->setProperty("sampleRate", benchmarkCase.sampleRate);
+   object->setProperty("frequency", benchmarkCase.frequency);
+   object->setProperty("channels", benchmarkCase.numChannels);
+   object->setProperty("trials", numTrials);
+   object->setProperty("blocks", numBlocks);
+   object->setProperty("nsPerSampleMedian", nsPerSampleMedian);
+   object->setProperty("nsPerSampleP99", nsPerSampleP99);
+   object->setProperty("nsPerSampleMean", nsPerSampleMean);
+   object->setProperty("samplesPerSecond", samplesPerSecond);
+   object->setProperty("realTimeMedian", realTimeMedian);
+   object->setProperty("realTimeP99", realTimeP99);
+   return var(object);
+}
+
+Benchmark::Benchmark (Options benchmarkOptions)
+: options (benchmarkOptions) {
+   engine.requestWavetables(tableSize);
+   bank.createTable(WavetableBank::Sawtooth);
+   engine.waitForWavetables();
+}
+
+BenchmarkResult Benchmark::run (const BenchmarkCase& benchmarkCase) {
+   buffer.setSize(benchmarkCase.numChannels, benchmarkCase.blockSize);
+   if (benchmarkCase.waveform == WaveEngine::NumWaveformIds) {
+      WavetableOscillator oscillator (bank.getTable(WavetableBank::Sawtooth));
+      oscillator.setInterpolation(benchmarkCase.interpolation);
+      oscillator.setFrequency((float) benchmarkCase.frequency, (float) benchmarkCase.sampleRate);
+      return measure(benchmarkCase, [&] (int numSamples) {
+         for (int chan = 0; chan < benchmarkCase.numChannels; ++chan) {
+            auto* samples = buffer.getWritePointer(chan);
+            for (int i = 0; i < numSamples; ++i) {
+               samples[i] = oscillator.getNextSample();
+            }
+         }
+      });
+   }
+   engine.prepare(benchmarkCase.sampleRate, benchmarkCase.numChannels);
+   engine.setInterpolation(benchmarkCase.interpolation);
+   engine.setWaveform(benchmarkCase.waveform);
+   engine.setFrequency(benchmarkCase.frequency);
+   engine.setLevel(0.5);
+   return measure(benchmarkCase, [&] (int numSamples) {
+      engine.process(buffer.getArrayOfWritePointers(), benchmarkCase.numChannels, numSamples);
+   });
+}
+
+template <typename Render>
+BenchmarkResult Benchmark::measure (const BenchmarkCase& benchmarkCase, Render&& render) {
+   auto blockSize = benchmarkCase.blockSize;
+   for (int i = 0; i < options.warmupBlocks; ++i) {
+      render(blockSize);
+   }
+   auto blocksPerTrial = jmax(1, options.samplesPerTrial / blockSize);
+   std::vector<double> times;
+   times.reserve((size_t) (options.numTrials * blocksPerTrial));
+   auto nsPerTick = 1.0e9 / (double) Time::getHighResolutionTicksPerSecond();
+   for (int trial = 0; trial < options.numTrials; ++trial) {
+      for (int block = 0; block < blocksPerTrial; ++block) {
+         auto start = Time::getHighResolutionTicks();
+         render(blockSize);
+         times.push_back((double) (Time::getHighResolutionTicks() - start) * nsPerTick);
+      }
+   }
+   std::sort(times.begin(), times.end());
+   auto median = times[times.size() / 2];
+   auto p99 = times[jmin(times.size() - 1, (size_t) std::ceil(0.99 * (double) times.size()) - 1)];
+   auto mean = std::accumulate(times.begin(), times.end(), 0.0) / (double) times.size();
+   auto samplesPerBlock = (double) blockSize * benchmarkCase.numChannels;
+   auto blockDuration = 1.0e9 * blockSize / benchmarkCase.sampleRate;
+
+   BenchmarkResult result;
+   result.benchmarkCase = benchmarkCase;
+   result.numTrials = options.numTrials;
+   result.numBlocks = (int) times.size();
+   result.nsPerSampleMedian = median / samplesPerBlock;
+   result.nsPerSampleP99 = p99 / samplesPerBlock;
+   result.nsPerSampleMean = mean / samplesPerBlock;
+   result.samplesPerSecond = 1.0e9 / jmax(result.nsPerSampleMedian, 1.0e-3);
+   result.realTimeMedian = median / blockDuration;
+   result.realTimeP99 = p99 / blockDuration;
+   return result;
+}
@@ -0,0 +1,79 @@
+//==============================================================================
+// Benchmark.h
+// Measures what each of WaveEngine's generators costs per sample.
+//==============================================================================
+
+#pragma once
+
+#include "../Source/WaveEngine.h"
+
+/// One generator measured at one block size, sample rate, frequency and
+/// channel count. A waveform renders through WaveEngine::process() exactly as
+/// the app plays it. With waveform set to NumWaveformIds the benchmark
+/// instead calls WavetableOscillator::getNextSample() once per sample on a
+/// sawtooth table, the scalar reference the WT_* kernels are measured against.
+struct BenchmarkCase
+{
+  WaveEngine::WaveformId waveform = WaveEngine::SineWave;
+  WavetableOscillator::Interpolation interpolation = WavetableOscillator::CubicHermite;
+  int blockSize = 512;
+  double sampleRate = 44100.0;
+  double frequency = 1000.0;
+  int numChannels = 2;
+
+  /// Returns the generator's name, e.g. "WT_SawtoothWave/CubicHermite" or
+  /// "getNextSample/Linear".
+  String getName() const;
+};
+
+/// The timings of a BenchmarkCase. Every block is timed on its own. The
+/// times per sample are per channel, so they compare across channel counts,
+/// and the fraction of real time is a block's time over the block's
+/// duration at the sample rate.
+struct BenchmarkResult
+{
+  BenchmarkCase benchmarkCase;
+  int numTrials = 0, numBlocks = 0;
+  double nsPerSampleMedian = 0.0, nsPerSampleP99 = 0.0, nsPerSampleMean = 0.0;
+  /// Channel samples per second at the median time.
+  double samplesPerSecond = 0.0;
+  double realTimeMedian = 0.0, realTimeP99 = 0.0;
+
+  /// Returns the result as a JSON object.
+  var toVar() const;
+};
+
+/// Benchmark runs BenchmarkCases. Every case is first rendered for
+/// warmupBlocks blocks, so the caches, branch predictors and CPU clock
+/// settle, and then for numTrials trials of samplesPerTrial samples each.
+/// The median and 99th percentile are taken over every block of every
+/// trial. The wavetables are built (or loaded from the WavetableCache) once,
+/// before the first case.
+class Benchmark
+{
+public:
+  struct Options
+  {
+    int warmupBlocks = 16;
+    int numTrials = 10;
+    int samplesPerTrial = 8192;
+  };
+
+  explicit Benchmark (Options options);
+
+  BenchmarkResult run (const BenchmarkCase& benchmarkCase);
+
+private:
+  /// Times render (numSamples) for a case, which must write numSamples of
+  /// each of the case's channels of buffer.
+  template <typename Render>
+  BenchmarkResult measure (const BenchmarkCase& benchmarkCase, Render&& render);
+
+  static constexpr int tableSize = 2048;
+
+  Options options;
+  WaveEngine engine;
+  /// The table getNextSample() reads.
+  WavetableBank bank {tableSize};
+  AudioBuffer<float> buffer;
+};
@@ -0,0 +1,155 @@
+//==============================================================================
+// Main.cpp
+// WaveBench, a command line tool that measures what each of Wave Lab's
+// generators costs per sample.
+//==============================================================================
+
+#include "Benchmark.h"
+#include <iostream>
+
+static const char* const usage =
+   "usage:\n"
+   "  WaveBench [--generators=NAME,...] [--interpolations=NAME,...]\n"
+   "            [--blockSizes=32,...] [--sampleRates=44100,...] [--frequencies=100,...]\n"
+   "            [--channels=1,...] [--trials=10] [--quick] [--json=FILE]\n"
+   "\n"
+   "Every generator is run at every combination of the block sizes, sample\n"
+   "rates, frequencies and channel counts (noise, which has no frequency, at\n"
+   "the first frequency only). The generators are WaveformId names (see\n"
+   "WaveRender --list) and getNextSample, which times\n"
+   "WavetableOscillator::getNextSample(). The WT_* waveforms and getNextSample\n"
+   "run with each of the interpolations. By default every generator runs at\n"
+   "block sizes 32 to 4096, sample rates 44100 to 192000, 100, 1000 and 5000\n"
+   "Hz and 1 and 2 channels; --quick runs a smaller grid. --json writes the\n"
+   "results, with a description of the machine, to FILE.\n";
+
+// Returns the comma separated values of an option, or defaultValues if the
+// option is missing.
+static StringArray getList (const ArgumentList& args, const String& option, const String& defaultValues) {
+   auto text = args.containsOption(option) ? args.getValueForOption(option) : defaultValues;
+   StringArray list;
+   list.addTokens(text, ",", "");
+   list.trim();
+   list.removeEmptyStrings();
+   return list;
+}
+
+static Result makeCases (const ArgumentList& args, std::vector<BenchmarkCase>& cases) {
+   auto quick = args.containsOption("--quick");
+   StringArray allGenerators;
+   for (int id = WaveEngine::WhiteNoise; id < WaveEngine::NumWaveformIds; ++id) {
+      allGenerators.add(WaveEngine::getWaveformName((WaveEngine::WaveformId) id));
+   }
+   allGenerators.add("getNextSample");
+   auto generators = getList(args, "--generators", allGenerators.joinIntoString(","));
+   auto interpolations = getList(args, "--interpolations", quick ? "CubicHermite" : "Linear,CubicHermite,Lagrange,WindowedSinc");
+   auto blockSizes = getList(args, "--blockSizes", quick ? "64,512,4096" : "32,64,128,256,512,1024,2048,4096");
+   auto sampleRates = getList(args, "--sampleRates", quick ? "48000" : "44100,48000,96000,192000");
+   auto frequencies = getList(args, "--frequencies", quick ? "1000" : "100,1000,5000");
+   auto channels = getList(args, "--channels", quick ? "2" : "1,2");
+
+   for (auto& name : interpolations) {
+      if (WaveEngine::findInterpolation(name) < 0) {
+         return Result::fail("unknown interpolation '" + name + "'");
+      }
+   }
+   for (auto& generator : generators) {
+      auto waveform = generator.equalsIgnoreCase("getNextSample") ? WaveEngine::NumWaveformIds
+         : WaveEngine::findWaveform(generator);
+      if (waveform == WaveEngine::NumWaveformIds && ! generator.equalsIgnoreCase("getNextSample")) {
+         return Result::fail("unknown generator '" + generator + "'");
+      }
+      // only the wavetables interpolate, and noise has no frequency
+      auto caseInterpolations = (waveform >= WaveEngine::WT_START) ? interpolations : StringArray("CubicHermite");
+      auto caseFrequencies = WaveEngine::hasFrequency(waveform) ? frequencies : StringArray(frequencies[0]);
+      for (auto& interpolation : caseInterpolations) {
+         for (auto& blockSize : blockSizes) {
+            for (auto& sampleRate : sampleRates) {
+               for (auto& frequency : caseFrequencies) {
+                  for (auto& numChannels : channels) {
+                     BenchmarkCase benchmarkCase;
+                     benchmarkCase.waveform = waveform;
+                     benchmarkCase.interpolation = (WavetableOscillator::Interpolation) WaveEngine::findInterpolation(interpolation);
+                     benchmarkCase.blockSize = blockSize.getIntValue();
+                     benchmarkCase.sampleRate = sampleRate.getDoubleValue();
+                     benchmarkCase.frequency = frequency.getDoubleValue();
+                     benchmarkCase.numChannels = numChannels.getIntValue();
+                     if (benchmarkCase.blockSize < 1 || benchmarkCase.sampleRate < 8000.0
+                         || benchmarkCase.numChannels < 1 || benchmarkCase.numChannels > WaveEngine::maxChannels) {
+                        return Result::fail("bad block size, sample rate or channel count");
+                     }
+                     cases.push_back(benchmarkCase);
+                  }
+               }
+            }
+         }
+      }
+   }
+   return Result::ok();
+}
+
+static var describeMachine() {
+   auto* object = new DynamicObject();
+   object->setProperty("cpu", SystemStats::getCpuModel());
+   object->setProperty("cores", SystemStats::getNumCpus());
+   object->setProperty("os", SystemStats::getOperatingSystemName());
+   object->setProperty("date", Time::getCurrentTime().toISO8601(true));
+   object->setProperty("juce", SystemStats::getJUCEVersion());
+  #if JUCE_DEBUG
+   object->setProperty("build", "debug");
+  #else
+   object->setProperty("build", "release");
+  #endif
+   return var(object);
+}
+
+int main (int argc, char* argv[]) {
+   ArgumentList args (argc, argv);
+   if (args.containsOption("--help|-h")) {
+      std::cout << usage;
+      return 0;
+   }
+   std::vector<BenchmarkCase> cases;
+   auto result = makeCases(args, cases);
+   if (result.failed()) {
+      std::cerr << result.getErrorMessage() << "\n\n" << usage;
+      return 1;
+   }
+
+   Benchmark::Options options;
+   if (args.containsOption("--trials")) {
+      options.numTrials = jmax(1, args.getValueForOption("--trials").getIntValue());
+   }
+   else if (args.containsOption("--quick")) {
+      options.numTrials = 5;
+   }
+   Benchmark benchmark (options);
+
+   Array<var> results;
+   for (auto& benchmarkCase : cases) {
+      auto measured = benchmark.run(benchmarkCase);
+      results.add(measured.toVar());
+      std::cout << benchmarkCase.getName().paddedRight(' ', 30)
+                << String(benchmarkCase.blockSize).paddedLeft(' ', 5) << " samples "
+                << String(benchmarkCase.sampleRate, 0).paddedLeft(' ', 6) << " Hz "
+                << String(benchmarkCase.frequency, 0).paddedLeft(' ', 5) << " Hz "
+                << benchmarkCase.numChannels << " ch  "
+                << String(measured.nsPerSampleMedian, 2).paddedLeft(' ', 8) << " ns/sample (p99 "
+                << String(measured.nsPerSampleP99, 2) << ")  "
+                << String(measured.samplesPerSecond * 1.0e-6, 1).paddedLeft(' ', 8) << " M samples/s  "
+                << String(measured.realTimeMedian * 100.0, 3) << "% of real time\n";
+   }
+
+   if (args.containsOption("--json")) {
+      auto* object = new DynamicObject();
+      var json (object);
+      object->setProperty("machine", describeMachine());
+      object->setProperty("results", results);
+      auto file = args.getFileForOption("--json");
+      if (! file.replaceWithText(JSON::toString(json))) {
+         std::cerr << "cannot write " << file.getFullPathName() << "\n";
+         return 1;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,167 @@
+//==============================================================================
+// Main.cpp
+// WaveRender, a command line tool that renders Wave Lab's waveforms to audio
+// files without an audio device.
+//==============================================================================
+
+#include "RenderJob.h"
+#include <iostream>
+
+static const char* const usage =
+   "usage:\n"
+   "  WaveRender --output=FILE [--waveform=NAME] [--level=0.5] [--frequency=440]\n"
+   "             [--sampleRate=44100] [--duration=1] [--channels=2] [--bitDepth=24]\n"
+   "             [--interpolation=CubicHermite] [--seed=0] [--bandLimited=false]\n"
+   "  WaveRender --manifest=JOBS.json [--threads=N]\n"
+   "  WaveRender --list\n"
+   "\n"
+   "The output format is chosen by the file extension (.wav, .aiff or .flac).\n"
+   "A manifest is a JSON array of jobs, or an object with a \"jobs\" array and\n"
+   "an optional \"defaults\" object whose fields apply to every job. Each job\n"
+   "has the fields of the single job options above, e.g.\n"
+   "  {\"waveform\": \"BL_SquareWave\", \"frequency\": 1000, \"output\": \"square.flac\"}\n"
+   "Relative outputs are resolved against the manifest's directory. The jobs\n"
+   "are rendered in parallel on N threads, by default one per core.\n";
+
+/// The fields a single job may be given as options.
+static const char* const fieldNames[] = {
+   "waveform", "level", "frequency", "sampleRate", "duration", "channels", "bitDepth", "interpolation",
+   "seed", "bandLimited", "output"
+};
+
+// Reads a single job from the options, which have the names of the JSON
+// fields. Numbers and booleans are passed as they are and anything else as
+// a string.
+static Result readJobFromOptions (const ArgumentList& args, RenderJob& job) {
+   auto* object = new DynamicObject();
+   var json (object);
+   for (auto* name : fieldNames) {
+      auto option = "--" + String(name);
+      if (args.containsOption(option)) {
+         auto text = args.getValueForOption(option);
+         auto parsed = JSON::parse(text);
+         auto isValue = parsed.isInt() || parsed.isInt64() || parsed.isDouble() || parsed.isBool();
+         object->setProperty(name, isValue ? parsed : var(text));
+      }
+   }
+   auto result = job.readFrom(json, File::getCurrentWorkingDirectory());
+   return result.failed() ? result : job.validate();
+}
+
+// Reads every job of a manifest, failing on the first bad one so that
+// nothing is rendered from a manifest with mistakes in it.
+static Result readManifest (const File& file, std::vector<RenderJob>& jobs) {
+   if (! file.existsAsFile()) {
+      return Result::fail("cannot find " + file.getFullPathName());
+   }
+   var manifest;
+   auto parsed = JSON::parse(file.loadFileAsString(), manifest);
+   if (parsed.failed()) {
+      return Result::fail(file.getFileName() + ": " + parsed.getErrorMessage());
+   }
+   auto list = manifest.isArray() ? manifest : manifest["jobs"];
+   if (! list.isArray()) {
+      return Result::fail(file.getFileName() + ": expected an array of jobs or a \"jobs\" array");
+   }
+   auto defaults = manifest.isArray() ? var() : manifest["defaults"];
+   auto directory = file.getParentDirectory();
+   StringArray outputs;
+   for (int i = 0; i < list.size(); ++i) {
+      RenderJob job;
+      auto result = defaults.isObject() ? job.readFrom(defaults, directory) : Result::ok();
+      if (result.wasOk()) {
+         result = job.readFrom(list[i], directory);
+      }
+      if (result.wasOk()) {
+         result = job.validate();
+      }
+      if (result.wasOk() && outputs.contains(job.output.getFullPathName())) {
+         result = Result::fail("another job also writes " + job.output.getFullPathName());
+      }
+      if (result.failed()) {
+         return Result::fail(file.getFileName() + ": job " + String(i + 1) + ": " + result.getErrorMessage());
+      }
+      outputs.add(job.output.getFullPathName());
+      jobs.push_back(job);
+   }
+   return Result::ok();
+}
+
+// Renders the jobs on numThreads threads and reports each one. Returns the
+// number that failed. The wavetables are loaded once and shared by every
+// job, and the last job to finish wakes this thread.
+static int renderJobs (const std::vector<RenderJob>& jobs, int numThreads) {
+   std::vector<Result> results (jobs.size(), Result::ok());
+   auto start = Time::getMillisecondCounterHiRes();
+   std::unique_ptr<WavetableBank> wavetables;
+   if (std::any_of(jobs.begin(), jobs.end(), [] (const RenderJob& job) { return job.needsWavetables(); })) {
+      wavetables = RenderJob::createWavetables();
+   }
+   if (! jobs.empty()) {
+      ThreadPool pool (jmax(1, jmin(numThreads, (int) jobs.size())));
+      std::atomic<size_t> remaining {jobs.size()};
+      WaitableEvent finished;
+      auto* bank = wavetables.get();
+      for (size_t i = 0; i < jobs.size(); ++i) {
+         pool.addJob([&jobs, &results, &remaining, &finished, bank, i] {
+            results[i] = jobs[i].render(bank);
+            if (--remaining == 0) {
+               finished.signal();
+            }
+         });
+      }
+      finished.wait();
+   }
+   auto seconds = (Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+   int numFailed = 0;
+   double audioSeconds = 0.0;
+   for (size_t i = 0; i < jobs.size(); ++i) {
+      auto& job = jobs[i];
+      if (results[i].failed()) {
+         std::cerr << "failed: " << job.output.getFullPathName() << ": " << results[i].getErrorMessage() << "\n";
+         ++numFailed;
+         continue;
+      }
+      audioSeconds += job.duration;
+      std::cout << job.output.getFullPathName() << "  " << WaveEngine::getWaveformName(job.waveform)
+                << " " << job.frequency << " Hz, " << job.duration << " s\n";
+   }
+   std::cout << (int) jobs.size() - numFailed << " of " << jobs.size() << " files, "
+             << audioSeconds << " s of audio in " << seconds << " s ("
+             << String(audioSeconds / jmax(seconds, 1.0e-6), 1) << "x real time)\n";
+   return numFailed;
+}
+
+int main (int argc, char* argv[]) {
+   ArgumentList args (argc, argv);
+   if (args.size() == 0 || args.containsOption("--help|-h")) {
+      std::cout << usage;
+      return args.size() == 0 ? 1 : 0;
+   }
+   if (args.containsOption("--list")) {
+      for (int id = WaveEngine::Empty; id < WaveEngine::NumWaveformIds; ++id) {
+         std::cout << WaveEngine::getWaveformName((WaveEngine::WaveformId) id) << "\n";
+      }
+      return 0;
+   }
+
+   std::vector<RenderJob> jobs;
+   auto result = Result::ok();
+   if (args.containsOption("--manifest")) {
+      result = readManifest(args.getFileForOption("--manifest"), jobs);
+   }
+   else {
+      RenderJob job;
+      result = readJobFromOptions(args, job);
+      jobs.push_back(job);
+   }
+   if (result.failed()) {
+      std::cerr << result.getErrorMessage() << "\n\n" << usage;
+      return 1;
+   }
+
+   auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+      : SystemStats::getNumCpus();
+   return renderJobs(jobs, numThreads) == 0 ? 0 : 1;
+}
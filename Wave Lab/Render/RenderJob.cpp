@@ -0,0 +1,160 @@
+//==============================================================================
+// RenderJob.cpp
+//==============================================================================
+
+#include "RenderJob.h"
+
+static bool isNumber (const var& value) {
+   return value.isInt() || value.isInt64() || value.isDouble();
+}
+
+Result RenderJob::readFrom (const var& json, const File& directory) {
+   auto* object = json.getDynamicObject();
+   if (object == nullptr) {
+      return Result::fail("a job must be a JSON object");
+   }
+   for (auto& property : object->getProperties()) {
+      auto name = property.name.toString();
+      auto& value = property.value;
+      if (name == "waveform") {
+         auto id = value.isString() ? WaveEngine::findWaveform(value.toString())
+            : isNumber(value) ? (WaveEngine::WaveformId) (int) value : WaveEngine::NumWaveformIds;
+         if (id < WaveEngine::Empty || id >= WaveEngine::NumWaveformIds) {
+            return Result::fail("unknown waveform '" + value.toString() + "'");
+         }
+         waveform = id;
+      }
+      else if (name == "interpolation") {
+         auto index = WaveEngine::findInterpolation(value.toString());
+         if (index < 0) {
+            return Result::fail("unknown interpolation '" + value.toString() + "'");
+         }
+         interpolation = (WavetableOscillator::Interpolation) index;
+      }
+      else if (name == "seed") {
+         if (! value.isInt() && ! value.isInt64()) {
+            return Result::fail("seed must be an integer");
+         }
+         seed = value;
+      }
+      else if (name == "bandLimited") {
+         if (! value.isBool()) {
+            return Result::fail("bandLimited must be true or false");
+         }
+         bandLimited = value;
+      }
+      else if (name == "output") {
+         if (value.toString().isEmpty()) {
+            return Result::fail("the output is empty");
+         }
+         output = directory.getChildFile(value.toString());
+      }
+      else if (name == "level" || name == "frequency" || name == "sampleRate" || name == "duration"
+               || name == "channels" || name == "bitDepth") {
+         if (! isNumber(value)) {
+            return Result::fail(name + " must be a number");
+         }
+         if (name == "level")           level = value;
+         else if (name == "frequency")  frequency = value;
+         else if (name == "sampleRate") sampleRate = value;
+         else if (name == "duration")   duration = value;
+         else if (name == "channels")   numChannels = value;
+         else                           bitDepth = value;
+      }
+      else {
+         return Result::fail("unknown field '" + name + "'");
+      }
+   }
+   return Result::ok();
+}
+
+Result RenderJob::validate() const {
+   if (output == File()) {
+      return Result::fail("no output file");
+   }
+   if (level < 0.0 || level > 1.0) {
+      return Result::fail("the level must be between 0 and 1");
+   }
+   if (sampleRate < 8000.0 || sampleRate > 768000.0) {
+      return Result::fail("the sample rate must be between 8000 and 768000");
+   }
+   if (frequency < 0.0 || frequency >= sampleRate * 0.5) {
+      return Result::fail("the frequency must be between 0 and half the sample rate");
+   }
+   if (duration <= 0.0) {
+      return Result::fail("the duration must be positive");
+   }
+   if (numChannels < 1 || numChannels > WaveEngine::maxChannels) {
+      return Result::fail("the channels must be between 1 and " + String(WaveEngine::maxChannels));
+   }
+   if (bitDepth != 16 && bitDepth != 24 && bitDepth != 32) {
+      return Result::fail("the bit depth must be 16, 24 or 32");
+   }
+   return Result::ok();
+}
+
+std::unique_ptr<WavetableBank> RenderJob::createWavetables() {
+   WavetableCache cache;
+   auto bank = std::make_unique<WavetableBank>(tableSize);
+   for (int waveform = 0; waveform < WavetableBank::NumWaveforms; ++waveform) {
+      bank->loadOrCreateTable(waveform, cache);
+   }
+   return bank;
+}
+
+// The file is written to a temporary file next to the output and moved over
+// it once complete, so a failed job never leaves a partial file behind.
+Result RenderJob::render (const WavetableBank* wavetables) const {
+   jassert(wavetables != nullptr || ! needsWavetables());
+   AudioFormatManager formats;
+   formats.registerBasicFormats();
+   auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+   if (format == nullptr) {
+      return Result::fail("no audio format writes '" + output.getFileExtension() + "' files");
+   }
+   auto created = output.getParentDirectory().createDirectory();
+   if (created.failed()) {
+      return created;
+   }
+   TemporaryFile temp (output);
+   std::unique_ptr<AudioFormatWriter> writer;
+   {
+      std::unique_ptr<FileOutputStream> stream (temp.getFile().createOutputStream());
+      if (stream == nullptr) {
+         return Result::fail("cannot write " + temp.getFile().getFullPathName());
+      }
+      writer.reset(format->createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels, bitDepth, {}, 0));
+      if (writer == nullptr) {
+         return Result::fail(format->getFormatName() + " cannot write " + String(numChannels) + " channels of "
+                             + String(bitDepth) + " bit audio at " + String(sampleRate) + " Hz");
+      }
+      // the writer owns the stream now
+      stream.release();
+   }
+
+   auto engine = std::make_unique<WaveEngine>();
+   engine->setWavetables(wavetables);
+   engine->prepare(sampleRate, numChannels, seed);
+   engine->setInterpolation(interpolation);
+   engine->setDustBandLimited(bandLimited);
+   engine->setWaveform(waveform);
+   engine->setFrequency(frequency);
+   engine->setLevel(level);
+
+   AudioBuffer<float> buffer (numChannels, blockSize);
+   auto length = (int64) std::llround(duration * sampleRate);
+   for (int64 position = 0; position < length;) {
+      auto numSamples = (int) jmin((int64) blockSize, length - position);
+      engine->process(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+      if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples)) {
+         return Result::fail("writing " + output.getFileName() + " failed");
+      }
+      position += numSamples;
+   }
+   // deleting the writer completes the file's header
+   writer.reset();
+   if (! temp.overwriteTargetFileWithTemporary()) {
+      return Result::fail("cannot replace " + output.getFullPathName());
+   }
+   return Result::ok();
+}
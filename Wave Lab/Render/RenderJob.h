@@ -0,0 +1,69 @@
+//==============================================================================
+// RenderJob.h
+// Renders one of WaveEngine's waveforms offline to an audio file.
+//==============================================================================
+
+#pragma once
+
+#include "../Source/WaveEngine.h"
+
+/// RenderJob describes one file for WaveRender to make: a waveform played at
+/// a fixed level and frequency for a duration, at a sample rate and channel
+/// count, written to a WAV, AIFF or FLAC file chosen by the file's
+/// extension. render() runs a WaveEngine of its own with no audio device,
+/// as fast as the machine allows, so any number of jobs can run in parallel.
+/// The jobs share one set of wavetables, made by createWavetables().
+///
+/// A job can be read from a JSON object with the fields below, all of them
+/// optional except "output"; fields that are missing keep their defaults:
+///
+///   { "waveform": "WT_SawtoothWave", "level": 0.5, "frequency": 440,
+///     "sampleRate": 48000, "duration": 2.0, "channels": 2, "bitDepth": 24,
+///     "interpolation": "CubicHermite", "seed": 0, "bandLimited": false,
+///     "output": "saw440.flac" }
+///
+/// The waveform is a WaveformId name (see WaveEngine::getWaveformName()) and
+/// the interpolation, used by the WT_* waveforms, one of "Linear",
+/// "CubicHermite", "Lagrange" or "WindowedSinc". The seed, an integer, seeds
+/// the noise waveforms: a job renders the same file every time, and jobs
+/// that should differ need different seeds. bandLimited makes DustNoise's
+/// impulses band limited rather than single samples.
+
+struct RenderJob
+{
+  WaveEngine::WaveformId waveform = WaveEngine::SineWave;
+  WavetableOscillator::Interpolation interpolation = WavetableOscillator::CubicHermite;
+  double level = 0.5;
+  double frequency = 440.0;
+  double sampleRate = 44100.0;
+  double duration = 1.0;
+  int numChannels = 2;
+  int bitDepth = 24;
+  int64 seed = 0;
+  bool bandLimited = false;
+  File output;
+
+  /// The size of the wavetables, the same as the app's.
+  static constexpr int tableSize = 2048;
+  /// The block size the engine renders.
+  static constexpr int blockSize = 512;
+
+  /// Reads the fields present in json into the job. A relative output path
+  /// is resolved against directory. Returns an error naming the first bad
+  /// field.
+  Result readFrom (const var& json, const File& directory);
+
+  /// Checks the job's values, returning an error if the job cannot be run.
+  Result validate() const;
+
+  /// Returns true if the job's waveform reads wavetables.
+  bool needsWavetables() const noexcept { return waveform >= WaveEngine::WT_START; }
+
+  /// Loads the wavetables of tableSize from the cache, or builds them, on
+  /// the calling thread, for the jobs to share.
+  static std::unique_ptr<WavetableBank> createWavetables();
+
+  /// Renders the job, replacing the output file. A job that needs
+  /// wavetables reads them from wavetables, which must not be nullptr.
+  Result render (const WavetableBank* wavetables) const;
+};
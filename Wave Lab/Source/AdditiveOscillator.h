@@ -0,0 +1,205 @@
+
+//==============================================================================
+// AdditiveOscillator.h
+// Band limited additive synthesis using recursively rotated harmonics.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// AdditiveOscillator sums sine harmonics of a fundamental up to the Nyquist
+/// limit. Instead of calling std::sin() for every harmonic of every sample,
+/// each harmonic is kept as a unit phasor (cos, sin) that is advanced by one
+/// complex multiplication per sample with a precomputed rotation coefficient.
+/// The harmonics are stored as parallel arrays (one entry per sounding
+/// harmonic, padded to a multiple of four) so the rotate and sum loops
+/// vectorize across harmonics. Amplitudes and coefficients are only
+/// recomputed when the frequency or the spectrum changes.
+
+class AdditiveOscillator
+{
+public:
+  /// The harmonic spectra the oscillator can generate.
+  enum Spectrum {
+    Impulse,   ///< All harmonics at 1/numHarmonics amplitude.
+    Square,    ///< Odd harmonics at 1/harmonic amplitude.
+    Sawtooth,  ///< All harmonics at 1/harmonic amplitude.
+    Triangle   ///< Odd harmonics at 1/harmonic**2 amplitude.
+  };
+
+  /// Allocates room for every harmonic of minFrequency below the Nyquist
+  /// limit so that frequency changes never allocate on the audio thread.
+  void prepare (double sampleRate, double minFrequency = 1.0)
+  {
+    auto capacity = padToLanes ((int) (sampleRate / 2.0 / minFrequency));
+    for (auto* array : {&amps, &rotCos, &rotSin, &cosState, &sinState})
+      array->assign ((size_t) capacity, 0.0f);
+    harmonics.assign ((size_t) capacity, 0);
+    numActive = numPadded = 0;
+    frequency = 0.0;
+    phase = 0.0;
+    dirty = true;
+  }
+
+  /// Sets the spectrum to generate. The harmonic arrays are rebuilt by the
+  /// next call to setFrequency().
+  void setSpectrum (Spectrum newSpectrum) noexcept
+  {
+    if (newSpectrum != spectrum) {
+      spectrum = newSpectrum;
+      dirty = true;
+    }
+  }
+
+  /// Limits the harmonics to those up to maxHarmonic, or with 0 to every
+  /// harmonic below the Nyquist limit. Fewer harmonics cost less to render.
+  /// The harmonic arrays are rebuilt by the next call to setFrequency().
+  void setMaxHarmonic (int newMaxHarmonic) noexcept
+  {
+    if (newMaxHarmonic != maxHarmonic) {
+      maxHarmonic = newMaxHarmonic;
+      dirty = true;
+    }
+  }
+
+  /// Sets the fundamental frequency. Does nothing if neither the frequency,
+  /// sample rate nor spectrum have changed, otherwise recomputes the harmonic
+  /// amplitudes and rotation coefficients and reseeds every harmonic's phasor
+  /// from the current fundamental phase so the waveform stays continuous.
+  void setFrequency (double newFrequency, double sampleRate) noexcept
+  {
+    if (! dirty && newFrequency == frequency && sampleRate == srate)
+      return;
+    dirty = false;
+    frequency = newFrequency;
+    srate = sampleRate;
+    phaseDelta = (srate > 0.0) ? frequency / srate : 0.0;
+    numActive = 0;
+    if (frequency > 0.0 && srate > 0.0) {
+      auto numHarmonic = srate / 2.0 / frequency;
+      auto capacity = (int) harmonics.size();
+      auto lastHarmonic = (maxHarmonic > 0) ? jmin (numHarmonic, (double) maxHarmonic) : numHarmonic;
+      auto step = (spectrum == Square || spectrum == Triangle) ? 2 : 1;
+      for (auto u = 1; u <= lastHarmonic && numActive < capacity; u += step) {
+        harmonics[(size_t) numActive] = u;
+        amps[(size_t) numActive] = (float) amplitude (u, numHarmonic);
+        auto delta = MathConstants<double>::twoPi * u * phaseDelta;
+        rotCos[(size_t) numActive] = (float) std::cos (delta);
+        rotSin[(size_t) numActive] = (float) std::sin (delta);
+        ++numActive;
+      }
+    }
+    // Padding harmonics are silent and never rotate.
+    numPadded = jmin (padToLanes (numActive), (int) harmonics.size());
+    for (auto h = numActive; h < numPadded; ++h) {
+      amps[(size_t) h] = rotSin[(size_t) h] = 0.0f;
+      rotCos[(size_t) h] = 1.0f;
+    }
+    reseed();
+  }
+
+  /// Resets the fundamental phase to zero.
+  void reset() noexcept
+  {
+    phase = 0.0;
+    reseed();
+  }
+
+  /// The fundamental phase, from 0 to 1. Harmonic u is sin (2 pi u phase).
+  double getPhase() const noexcept { return phase; }
+
+  void setPhase (double newPhase) noexcept
+  {
+    phase = newPhase - std::floor (newPhase);
+    reseed();
+  }
+
+  /// Overwrites numSamples of output with the sum of the harmonics scaled by
+  /// gain. Each sample costs one multiply-add and one complex rotation per
+  /// sounding harmonic.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    if (numActive == 0) {
+      FloatVectorOperations::clear (output, numSamples);
+      return;
+    }
+    auto* amp = amps.data();
+    auto* rc = rotCos.data();
+    auto* rs = rotSin.data();
+    auto* re = cosState.data();
+    auto* im = sinState.data();
+    for (int i = 0; i < numSamples; ++i) {
+      float acc[lanes] = {};
+      for (int k = 0; k < numPadded; k += lanes) {
+        for (int j = 0; j < lanes; ++j) {
+          auto h = k + j;
+          acc[j] += amp[h] * im[h];
+          auto c = re[h];
+          re[h] = c * rc[h] - im[h] * rs[h];
+          im[h] = c * rs[h] + im[h] * rc[h];
+        }
+      }
+      output[i] = gain * ((acc[0] + acc[1]) + (acc[2] + acc[3]));
+    }
+    phase += numSamples * phaseDelta;
+    phase -= std::floor (phase);
+    renormalize();
+  }
+
+private:
+  /// Number of harmonics processed together by the inner loops.
+  static constexpr int lanes = 4;
+
+  static int padToLanes (int n) noexcept { return (n + lanes - 1) / lanes * lanes; }
+
+  /// Returns the amplitude of harmonic u out of numHarmonic harmonics.
+  double amplitude (int u, double numHarmonic) const noexcept
+  {
+    switch (spectrum) {
+      case Impulse:  return 1.0 / numHarmonic;
+      case Square:   return 1.0 / u;
+      case Sawtooth: return 1.0 / u;
+      case Triangle: return 1.0 / ((double) u * u);
+    }
+    return 0.0;
+  }
+
+  /// Sets every harmonic's phasor to its exact position for the current
+  /// fundamental phase.
+  void reseed() noexcept
+  {
+    for (auto h = 0; h < numPadded; ++h) {
+      auto angle = MathConstants<double>::twoPi * harmonics[(size_t) h] * phase;
+      cosState[(size_t) h] = (float) std::cos (angle);
+      sinState[(size_t) h] = (float) std::sin (angle);
+    }
+  }
+
+  /// Pulls every phasor back onto the unit circle. Rounding makes the
+  /// rotated phasors grow or shrink very slowly, so a first order correction
+  /// once per block is enough to keep their magnitudes at 1.
+  void renormalize() noexcept
+  {
+    auto* re = cosState.data();
+    auto* im = sinState.data();
+    for (int h = 0; h < numPadded; ++h) {
+      auto g = 1.5f - 0.5f * (re[h] * re[h] + im[h] * im[h]);
+      re[h] *= g;
+      im[h] *= g;
+    }
+  }
+
+  Spectrum spectrum = Sawtooth;
+  bool dirty = true;
+  /// The highest harmonic, or 0 for no limit.
+  int maxHarmonic = 0;
+  double frequency = 0.0, srate = 0.0;
+  /// Fundamental phase (0-1) and its per sample increment.
+  double phase = 0.0, phaseDelta = 0.0;
+  /// Number of sounding harmonics, and that number padded to a multiple of lanes.
+  int numActive = 0, numPadded = 0;
+  /// Harmonic numbers, amplitudes, rotation coefficients and phasor states.
+  std::vector<int> harmonics;
+  std::vector<float> amps, rotCos, rotSin, cosState, sinState;
+};
@@ -0,0 +1,91 @@
+
+//==============================================================================
+// AtomicSnapshot.h
+// Hands immutable objects from a background thread to the audio thread.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// AtomicSnapshot passes ownership of heap objects (e.g. a set of wavetables)
+/// from the message or a worker thread to the audio thread without locks,
+/// and without the audio thread ever allocating or freeing memory.
+/// * publish() stores a new object in an atomic 'pending' pointer. If the
+///   audio thread never picked up the previous pending object it is deleted,
+///   which is safe because the audio thread never saw it.
+/// * acquire() is called by the audio thread. It exchanges the pending
+///   pointer for nullptr, makes it the current object and hands the object
+///   it replaces to a single producer/single consumer retire queue.
+/// * collectGarbage() deletes the retired objects on a non-audio thread.
+/// An object returned by acquire() stays valid until the next acquire() on
+/// the audio thread. publish() may be called from any non-audio thread,
+/// collectGarbage() from one non-audio thread at a time.
+
+template <typename ObjectType>
+class AtomicSnapshot
+{
+public:
+  AtomicSnapshot() = default;
+
+  /// Deletes every object. The audio thread must no longer be calling acquire().
+  ~AtomicSnapshot()
+  {
+    delete pending.exchange (nullptr);
+    delete current;
+    collectGarbage();
+  }
+
+  /// Publishes a new object, replacing any object still pending.
+  void publish (std::unique_ptr<ObjectType> object)
+  {
+    delete pending.exchange (object.release(), std::memory_order_acq_rel);
+  }
+
+  /// Called on the audio thread. Returns the most recently published object
+  /// (or nullptr if nothing has been published). The switch to a newly
+  /// published object is postponed if the retire queue is full.
+  ObjectType* acquire() noexcept
+  {
+    if (pending.load (std::memory_order_relaxed) != nullptr && retired.getFreeSpace() > 0) {
+      if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel)) {
+        if (current != nullptr)
+          retire (current);
+        current = next;
+      }
+    }
+    return current;
+  }
+
+  /// Called on the audio thread. Returns the current object without
+  /// checking for a newly published one.
+  ObjectType* getCurrent() const noexcept { return current; }
+
+  /// Deletes the objects the audio thread has retired.
+  void collectGarbage()
+  {
+    const auto scope = retired.read (retired.getNumReady());
+    for (auto i = 0; i < scope.blockSize1; ++i)
+      delete retiredObjects[(size_t) (scope.startIndex1 + i)];
+    for (auto i = 0; i < scope.blockSize2; ++i)
+      delete retiredObjects[(size_t) (scope.startIndex2 + i)];
+  }
+
+private:
+  void retire (ObjectType* object) noexcept
+  {
+    const auto scope = retired.write (1);
+    jassert (scope.blockSize1 + scope.blockSize2 == 1);
+    retiredObjects[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = object;
+  }
+
+  static constexpr int retireCapacity = 16;
+
+  std::atomic<ObjectType*> pending {nullptr};
+  /// The object in use by the audio thread. Only the audio thread touches it.
+  ObjectType* current = nullptr;
+  AbstractFifo retired {retireCapacity};
+  std::array<ObjectType*, retireCapacity> retiredObjects {};
+
+  JUCE_DECLARE_NON_COPYABLE (AtomicSnapshot)
+};
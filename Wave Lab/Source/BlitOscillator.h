@@ -0,0 +1,115 @@
+
+//==============================================================================
+// BlitOscillator.h
+// Closed form band limited impulse trains (BLIT) and BLIT sawtooth waves.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+#include "FastMath.h"
+
+/// BlitOscillator generates a band limited impulse train with the discrete
+/// summation formula for the Dirichlet kernel:
+///   1 + 2 * sum(cos(k*x), k=1..N) = sin((N + 1/2) * x) / sin(x / 2)
+/// so summing the N harmonics below the Nyquist limit costs the same few
+/// sin() calls per sample for any frequency. The harmonic count does not
+/// jump when the frequency changes, instead the top harmonic is faded in
+/// and out by interpolating between the kernels for N-1 and N harmonics.
+/// The sawtooth is the impulse train passed through a leaky integrator.
+/// The sines are FastMath's 24 bit tier evaluated in double: its error is
+/// relative, so it stays small where the kernel divides by sin(x/2) near 0.
+
+class BlitOscillator
+{
+public:
+  /// The waveforms the oscillator can generate.
+  enum Shape { Impulse, Sawtooth };
+
+  void setShape (Shape newShape) noexcept { shape = newShape; }
+
+  /// Sets the frequency of the oscillator and the (fractional) number of
+  /// harmonics that fit below the Nyquist limit, at most maxHarmonics. A
+  /// frequency of 0 silences the oscillator.
+  void setFrequency (double frequency, double sampleRate) noexcept
+  {
+    if (frequency <= 0.0 || sampleRate <= 0.0) {
+      phaseDelta = numHarmonic = fraction = 0.0;
+      numWhole = 0;
+      return;
+    }
+    phaseDelta = frequency / sampleRate;
+    numHarmonic = jmin (sampleRate / 2.0 / frequency, (double) maxHarmonics);
+    numWhole = (int) numHarmonic;
+    fraction = numHarmonic - numWhole;
+    // the integrator forgets its state with a time constant of about 0.1 seconds
+    leak = std::exp (-MathConstants<double>::twoPi * 2.0 / sampleRate);
+  }
+
+  /// Resets the phase to the start of a period. The integrator is set to the
+  /// bottom of the sawtooth, the value just before the period's impulse.
+  void reset() noexcept
+  {
+    phase = 0.0;
+    integrator = -1.0;
+  }
+
+  /// Overwrites numSamples of output with the waveform scaled by gain. The
+  /// impulse train is normalized so its peak is about 1.0, the sawtooth
+  /// ranges about -1.0 to 1.0.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    if (numWhole < 1) {
+      FloatVectorOperations::clear (output, numSamples);
+      return;
+    }
+    auto lowOrder = 2.0 * numWhole - 1.0;
+    auto highOrder = 2.0 * numWhole + 1.0;
+    auto scale = 1.0 / numHarmonic;
+    auto slope = 4.0 * phaseDelta;
+    for (int i = 0; i < numSamples; ++i) {
+      // Center the phase on the impulse so sin(x/2) only approaches zero
+      // where its argument is exact, and use the kernel's limit there.
+      auto halfAngle = MathConstants<double>::pi * ((phase < 0.5) ? phase : phase - 1.0);
+      auto denominator = FastMath::sin<accuracy> (halfAngle);
+      double low, high;
+      if (std::abs (denominator) < 1.0e-9) {
+        low = lowOrder;
+        high = highOrder;
+      }
+      else {
+        low = FastMath::sin<accuracy> (lowOrder * halfAngle) / denominator;
+        high = FastMath::sin<accuracy> (highOrder * halfAngle) / denominator;
+      }
+      // sum of the cosine harmonics, without the kernel's DC term
+      auto sum = 0.5 * (low + fraction * (high - low) - 1.0);
+      if (shape == Impulse) {
+        output[i] = (float) (sum * scale) * gain;
+      }
+      else {
+        // integrating cos(k*x) over x gives sin(k*x)/k, the sawtooth's
+        // harmonics. 4*phaseDelta is 2*pi*phaseDelta scaled by 2/pi.
+        integrator = leak * integrator + slope * sum;
+        output[i] = (float) integrator * gain;
+      }
+      phase += phaseDelta;
+      if (phase >= 1.0)
+        phase -= 1.0;
+    }
+  }
+
+private:
+  static constexpr FastMath::Accuracy accuracy = FastMath::Accuracy::Bits24;
+  /// The most harmonics summed, which a frequency gliding towards 0 would
+  /// otherwise take past the range of an int.
+  static constexpr int maxHarmonics = 1 << 20;
+
+  Shape shape = Impulse;
+  double phase = 0.0, phaseDelta = 0.0;
+  /// The number of harmonics below the Nyquist limit, its whole part and
+  /// the fraction used to fade the top harmonic.
+  double numHarmonic = 0.0, fraction = 0.0;
+  int numWhole = 0;
+  /// The leaky integrator's state and coefficient.
+  double integrator = -1.0, leak = 1.0;
+};
@@ -0,0 +1,135 @@
+//==============================================================================
+// BlockProfiler.cpp
+//==============================================================================
+
+#include "BlockProfiler.h"
+
+//==============================================================================
+// Stats
+//==============================================================================
+
+double BlockProfiler::Stats::getLoadPercentile (double proportion) const noexcept {
+   if (numBlocks == 0) {
+      return 0.0;
+   }
+   auto target = (int64) std::ceil(jlimit(0.0, 1.0, proportion) * (double) numBlocks);
+   int64 count = 0;
+   for (int bucket = 0; bucket < numBuckets - 1; ++bucket) {
+      count += counts[(size_t) bucket];
+      if (count >= jmax((int64) 1, target)) {
+         return jmin((double) (bucket + 1) / 100.0, maxLoad);
+      }
+   }
+   // the last bucket has no upper edge
+   return maxLoad;
+}
+
+var BlockProfiler::Stats::toVar() const {
+   auto* object = new DynamicObject();
+   object->setProperty("blocks", numBlocks);
+   object->setProperty("overruns", numOverruns);
+   object->setProperty("meanSeconds", getMeanSeconds());
+   object->setProperty("maxSeconds", maxSeconds);
+   object->setProperty("loadMedian", getLoadPercentile(0.5));
+   object->setProperty("loadP99", getLoadPercentile(0.99));
+   object->setProperty("loadP999", getLoadPercentile(0.999));
+   object->setProperty("loadMax", maxLoad);
+   // the histogram in percent of the deadline, without its empty tail
+   auto last = numBuckets - 1;
+   while (last >= 0 && counts[(size_t) last] == 0) {
+      --last;
+   }
+   Array<var> histogram;
+   for (int bucket = 0; bucket <= last; ++bucket) {
+      histogram.add((int) counts[(size_t) bucket]);
+   }
+   object->setProperty("histogram", histogram);
+   return var(object);
+}
+
+//==============================================================================
+// Histogram
+//==============================================================================
+
+void BlockProfiler::Histogram::clear() noexcept {
+   for (auto& count : counts) {
+      count.store(0, std::memory_order_relaxed);
+   }
+   numBlocks.store(0, std::memory_order_relaxed);
+   numOverruns.store(0, std::memory_order_relaxed);
+   totalTicks.store(0, std::memory_order_relaxed);
+   maxTicks.store(0, std::memory_order_relaxed);
+   maxLoad.store(0.0f, std::memory_order_relaxed);
+}
+
+void BlockProfiler::Histogram::add (int bucket, int64 ticks, float load, bool overrun) noexcept {
+   auto& count = counts[(size_t) bucket];
+   count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   totalTicks.store(totalTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+   if (overrun) {
+      numOverruns.store(numOverruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   }
+   if (ticks > maxTicks.load(std::memory_order_relaxed)) {
+      maxTicks.store(ticks, std::memory_order_relaxed);
+   }
+   if (load > maxLoad.load(std::memory_order_relaxed)) {
+      maxLoad.store(load, std::memory_order_relaxed);
+   }
+}
+
+//==============================================================================
+// BlockProfiler
+//==============================================================================
+
+BlockProfiler::BlockProfiler (int numSources)
+: sources ((size_t) jmax(1, numSources)) {
+}
+
+void BlockProfiler::prepare (double sampleRate) noexcept {
+   ticksPerSample = (sampleRate > 0.0) ? (double) Time::getHighResolutionTicksPerSecond() / sampleRate : 0.0;
+}
+
+void BlockProfiler::endBlock (int64 startTicks, int numSamples, int source) noexcept {
+   auto ticks = Time::getHighResolutionTicks() - startTicks;
+   if (resetRequested.load(std::memory_order_acquire) && resetRequested.exchange(false)) {
+      total.clear();
+      for (auto& histogram : sources) {
+         histogram.clear();
+      }
+   }
+   auto deadline = ticksPerSample.load(std::memory_order_relaxed) * numSamples;
+   if (deadline <= 0.0) {
+      return;
+   }
+   auto load = (double) ticks / deadline;
+   auto bucket = (int) jmin(load * 100.0, (double) (numBuckets - 1));
+   auto overrun = load > 1.0;
+   total.add(bucket, ticks, (float) load, overrun);
+   sources[(size_t) jlimit(0, getNumSources() - 1, source)].add(bucket, ticks, (float) load, overrun);
+}
+
+BlockProfiler::Stats BlockProfiler::getStats (int source) const noexcept {
+   Stats stats;
+   if (resetRequested.load(std::memory_order_acquire)) {
+      return stats;
+   }
+   if (source < 0) {
+      copy(total, stats);
+   }
+   else if (source < getNumSources()) {
+      copy(sources[(size_t) source], stats);
+   }
+   return stats;
+}
+
+void BlockProfiler::copy (const Histogram& histogram, Stats& stats) const noexcept {
+   for (int bucket = 0; bucket < numBuckets; ++bucket) {
+      stats.counts[(size_t) bucket] = histogram.counts[(size_t) bucket].load(std::memory_order_relaxed);
+   }
+   stats.numBlocks = histogram.numBlocks.load(std::memory_order_relaxed);
+   stats.numOverruns = histogram.numOverruns.load(std::memory_order_relaxed);
+   stats.totalSeconds = (double) histogram.totalTicks.load(std::memory_order_relaxed) * secondsPerTick;
+   stats.maxSeconds = (double) histogram.maxTicks.load(std::memory_order_relaxed) * secondsPerTick;
+   stats.maxLoad = histogram.maxLoad.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,105 @@
+//==============================================================================
+// BlockProfiler.h
+// Times each audio block against its deadline without locking.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// BlockProfiler records how long each audio block took, as a fraction of
+/// the block's deadline (its duration at the sample rate), in a histogram
+/// of 1% buckets from 0 to 200%. A block that takes longer than its deadline
+/// is an overrun: on a device with no more buffering than one block it is
+/// heard as a dropout. Each block is also attributed to a source (e.g. the
+/// waveform that was playing), which has a histogram of its own, so the
+/// worst case of each generator can be told apart.
+///
+/// The audio thread times a block with startBlock() and endBlock(), which
+/// read Time::getHighResolutionTicks() and store a few counters without
+/// locking or allocating. Only the audio thread writes the counters, so they
+/// are stored rather than atomically incremented. Any other thread
+/// reads the counters with getStats(). The counters are read one at a time,
+/// so a Stats may be a block apart between its fields.
+
+class BlockProfiler
+{
+public:
+  /// The number of histogram buckets. Bucket i counts the blocks that took
+  /// i% to (i+1)% of their deadline, and the last bucket every block that
+  /// took longer.
+  static constexpr int numBuckets = 201;
+
+  /// A copy of the counters of one source, or of all of them.
+  struct Stats
+  {
+    std::array<uint32, numBuckets> counts {};
+    int64 numBlocks = 0, numOverruns = 0;
+    /// The total and longest block times, in seconds.
+    double totalSeconds = 0.0, maxSeconds = 0.0;
+    /// The largest fraction of a deadline any block took.
+    double maxLoad = 0.0;
+
+    double getMeanSeconds() const noexcept { return numBlocks > 0 ? totalSeconds / (double) numBlocks : 0.0; }
+
+    /// Returns the fraction of a deadline that proportion (0 to 1) of the
+    /// blocks took no longer than, to the nearest bucket above.
+    double getLoadPercentile (double proportion) const noexcept;
+
+    /// Returns the stats as a JSON object.
+    var toVar() const;
+  };
+
+  /// Creates a profiler whose blocks are attributed to sources 0 to
+  /// numSources - 1.
+  explicit BlockProfiler (int numSources);
+
+  /// Sets the sample rate the deadlines are computed at. Call before the
+  /// audio thread starts timing blocks.
+  void prepare (double sampleRate) noexcept;
+
+  /// Called on the audio thread at the start of a block. Returns the time to
+  /// pass to endBlock().
+  static int64 startBlock() noexcept { return Time::getHighResolutionTicks(); }
+
+  /// Called on the audio thread at the end of a block of numSamples that
+  /// started at startTicks, attributing it to source.
+  void endBlock (int64 startTicks, int numSamples, int source) noexcept;
+
+  /// Clears the counters. May be called from any thread. The audio thread
+  /// clears them at its next block, and until then getStats() returns
+  /// empty stats.
+  void reset() noexcept { resetRequested = true; }
+
+  int getNumSources() const noexcept { return (int) sources.size(); }
+
+  /// Returns the counters of source, or with source -1 the counters of every
+  /// block.
+  Stats getStats (int source = -1) const noexcept;
+
+private:
+  struct Histogram
+  {
+    Histogram() { clear(); }
+
+    void clear() noexcept;
+
+    /// Adds a block. Only the audio thread writes, so each counter is
+    /// loaded and stored rather than incremented atomically.
+    void add (int bucket, int64 ticks, float load, bool overrun) noexcept;
+
+    std::array<std::atomic<uint32>, numBuckets> counts;
+    std::atomic<int64> numBlocks, numOverruns, totalTicks, maxTicks;
+    std::atomic<float> maxLoad;
+  };
+
+  void copy (const Histogram& histogram, Stats& stats) const noexcept;
+
+  Histogram total;
+  std::vector<Histogram> sources;
+  std::atomic<double> ticksPerSample {0.0};
+  std::atomic<bool> resetRequested {false};
+  const double secondsPerTick = 1.0 / (double) Time::getHighResolutionTicksPerSecond();
+
+  JUCE_DECLARE_NON_COPYABLE (BlockProfiler)
+};
@@ -0,0 +1,206 @@
+
+//==============================================================================
+// ColoredNoise.h
+// White, brown, pink, blue and violet noise with state kept across blocks.
+//==============================================================================
+
+#pragma once
+
+#include "NoiseGenerator.h"
+
+/// ColoredNoise shapes the uniform white noise of a NoiseGenerator into
+/// noise whose power falls or rises with frequency:
+/// * White is flat.
+/// * Brown falls by 6 dB per octave. It is white noise through a leaky
+///   integrator, flat below a corner of a few hertz so it cannot drift.
+/// * Pink falls by 3 dB per octave. It is the Voss-McCartney algorithm: the
+///   sum of 16 random values where value r is replaced every 2^(r+1)
+///   samples (the last, every 2^15), the one to replace being the number of
+///   trailing zeros of a counter.
+/// * Blue rises by 3 dB per octave, the first difference of pink.
+/// * Violet rises by 6 dB per octave, the first difference of white.
+/// Every filter's state is kept from one block to the next. The integrator
+/// is evaluated a SIMD register of samples at a time: each output in the
+/// register is the previous register's last output times a power of the
+/// feedback coefficient plus a weighted sum of the register's inputs, so
+/// the recursion only passes between registers rather than samples. The
+/// colors other than white are scaled to an RMS of about 0.25 so that
+/// their peaks seldom exceed 1. Use one object per channel.
+
+class ColoredNoise
+{
+public:
+  enum Color { White, Brown, Pink, Blue, Violet };
+
+  explicit ColoredNoise (uint64 seed = 0)
+  : white (seed)
+  {
+    prepare (44100.0);
+  }
+
+  /// Sets the sample rate, which sets the brown noise's corner frequency.
+  void prepare (double sampleRate)
+  {
+    auto feedback = std::exp (-MathConstants<double>::twoPi * brownCorner / sampleRate);
+    // scales the integrator's output to the target RMS: white noise of
+    // variance 1/3 integrated with feedback a has a variance of g^2 / (3 (1 - a^2))
+    auto gain = targetRms * std::sqrt (3.0 * (1.0 - feedback * feedback));
+    setIntegrator ((float) feedback, (float) gain);
+    reset();
+  }
+
+  /// Clears the filter states.
+  void reset() noexcept
+  {
+    integrator = 0.0f;
+    lastPink = lastWhite = 0.0f;
+    rows.fill (0.0f);
+    pinkSum = 0.0f;
+    counter = 0;
+  }
+
+  /// Sets the color. Only the current color's filter runs, so the others
+  /// keep the state they had when they last ran, and a color switched back
+  /// to continues from there rather than from silence.
+  void setColor (Color newColor) noexcept { color = newColor; }
+
+  Color getColor() const noexcept { return color; }
+
+  /// Overwrites numSamples of output with noise scaled by gain.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    white.renderBlock (0, output, numSamples, 1.0f);
+    white.advance (numSamples);
+    switch (color) {
+      case White:
+        break;
+      case Brown:
+        integrate (output, numSamples);
+        break;
+      case Pink:
+        pink (output, numSamples);
+        break;
+      case Blue:
+        pink (output, numSamples);
+        difference (output, numSamples, blueScale, lastPink);
+        break;
+      case Violet:
+        difference (output, numSamples, violetScale, lastWhite);
+        break;
+    }
+    if (gain != 1.0f)
+      FloatVectorOperations::multiply (output, gain, numSamples);
+  }
+
+private:
+  using SIMDFloat = dsp::SIMDRegister<float>;
+  static constexpr int numLanes = (int) SIMDFloat::SIMDNumElements;
+  static constexpr int numRows = 16;
+
+  static constexpr double brownCorner = 5.0;
+  static constexpr double targetRms = 0.25;
+  /// The sum of numRows uniform values has a variance of numRows / 3.
+  static constexpr float pinkScale = 0.25f * 0.4330127f; // targetRms * sqrt (3 / numRows)
+  /// The difference of the scaled pink noise has an RMS of about 0.088 (measured).
+  static constexpr float blueScale = 0.25f / 0.088f;
+  /// The difference of uniform white noise has a variance of 2/3.
+  static constexpr float violetScale = 0.25f * 1.2247449f; // targetRms * sqrt (3 / 2)
+
+  /// Sets y[n] = a * y[n-1] + g * x[n] and its per register coefficients.
+  /// Lane k of a register's output is
+  ///   a^(k+1) * y[-1] + sum (g * a^(k-j) * x[j], j = 0..k)
+  void setIntegrator (float a, float g) noexcept
+  {
+    feedback = a;
+    inputGain = g;
+    alignas (SIMDFloat::SIMDRegisterSize) float lanes[numLanes];
+    for (int k = 0; k < numLanes; ++k)
+      lanes[k] = std::pow (a, (float) (k + 1));
+    carryWeights = SIMDFloat::fromRawArray (lanes);
+    for (int j = 0; j < numLanes; ++j) {
+      for (int k = 0; k < numLanes; ++k)
+        lanes[k] = (k >= j) ? g * std::pow (a, (float) (k - j)) : 0.0f;
+      inputWeights[(size_t) j] = SIMDFloat::fromRawArray (lanes);
+    }
+  }
+
+  /// Runs the leaky integrator over the samples in place. Samples before
+  /// the first aligned one and after the last whole register are done one
+  /// at a time.
+  void integrate (float* samples, int numSamples) noexcept
+  {
+    auto* aligned = jmin (SIMDFloat::getNextSIMDAlignedPtr (samples), samples + numSamples);
+    auto numHead = (int) (aligned - samples);
+    integrateScalar (samples, numHead);
+    auto numVector = (numSamples - numHead) / numLanes * numLanes;
+    for (int i = 0; i < numVector; i += numLanes) {
+      auto* x = aligned + i;
+      auto y = carryWeights * integrator;
+      for (int j = 0; j < numLanes; ++j)
+        y += inputWeights[(size_t) j] * x[j];
+      y.copyToRawArray (x);
+      integrator = x[numLanes - 1];
+    }
+    integrateScalar (aligned + numVector, numSamples - numHead - numVector);
+  }
+
+  void integrateScalar (float* samples, int numSamples) noexcept
+  {
+    for (int i = 0; i < numSamples; ++i)
+      samples[i] = integrator = feedback * integrator + inputGain * samples[i];
+  }
+
+  /// Replaces the white samples with the Voss-McCartney sum, using each
+  /// white sample as the new value of one row.
+  void pink (float* samples, int numSamples) noexcept
+  {
+    auto sum = pinkSum;
+    for (int i = 0; i < numSamples; ++i) {
+      // the bit above the rows caps the count at numRows - 1
+      auto row = countTrailingZeros (++counter | (1u << (numRows - 1)));
+      sum += samples[i] - rows[(size_t) row];
+      rows[(size_t) row] = samples[i];
+      samples[i] = sum * pinkScale;
+    }
+    // resum the rows so rounding errors cannot accumulate in the running sum
+    pinkSum = std::accumulate (rows.begin(), rows.end(), 0.0f);
+  }
+
+  /// Replaces the samples with their first difference times scale, where
+  /// lastInput is the sample before them and becomes the last of them. Runs
+  /// backwards so it can work in place.
+  static void difference (float* samples, int numSamples, float scale, float& lastInput) noexcept
+  {
+    if (numSamples <= 0)
+      return;
+    auto last = samples[numSamples - 1];
+    for (int i = numSamples - 1; i > 0; --i)
+      samples[i] = (samples[i] - samples[i - 1]) * scale;
+    samples[0] = (samples[0] - lastInput) * scale;
+    lastInput = last;
+  }
+
+  static int countTrailingZeros (uint32 x) noexcept
+  {
+   #if JUCE_MSVC
+    unsigned long index;
+    _BitScanForward (&index, x);
+    return (int) index;
+   #else
+    return __builtin_ctz (x);
+   #endif
+  }
+
+  NoiseGenerator white;
+  Color color = White;
+  /// The leaky integrator's coefficients and its output.
+  float feedback = 0.0f, inputGain = 0.0f, integrator = 0.0f;
+  /// The last inputs of the blue and violet differences.
+  float lastPink = 0.0f, lastWhite = 0.0f;
+  SIMDFloat carryWeights;
+  std::array<SIMDFloat, numLanes> inputWeights;
+  /// The Voss-McCartney rows, their sum and the sample counter.
+  std::array<float, numRows> rows;
+  float pinkSum = 0.0f;
+  uint32 counter = 0;
+};
@@ -0,0 +1,113 @@
+
+//==============================================================================
+// DustGenerator.h
+// Randomly timed impulses scheduled by their exponential inter-arrival times.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+#include "WindowedSincKernel.h"
+
+/// DustGenerator produces impulses of random amplitude at random times, a
+/// Poisson process with a given average density (impulses per second).
+/// Instead of testing every sample for an impulse it draws the time to the
+/// next impulse from the exponential distribution, jumps straight to it and
+/// carries the remaining wait into the next block, so the cost depends on
+/// the number of impulses rather than the sample rate. Impulses are either
+/// single samples on the whole sample at or before their time, or band
+/// limited impulses placed at their exact fractional time by a windowed sinc. Those spread
+/// over 8 samples and are delayed by 3 samples; the part that falls after
+/// the end of a block is added to the start of the next.
+
+class DustGenerator
+{
+public:
+  explicit DustGenerator (int64 seed = 0)
+  : random (seed)
+  {
+    // builds the sinc kernel now rather than on the audio thread
+    WindowedSincKernel::get();
+  }
+
+  /// Sets the average number of impulses per second. A density of 0 stops
+  /// the impulses.
+  void setDensity (double impulsesPerSecond, double sampleRate) noexcept
+  {
+    auto interval = (impulsesPerSecond > 0.0 && sampleRate > 0.0) ? sampleRate / impulsesPerSecond : 0.0;
+    if (interval == meanInterval)
+      return;
+    meanInterval = interval;
+    // the process is memoryless, so the pending wait can simply be redrawn
+    if (meanInterval > 0.0)
+      samplesToNext = drawInterval();
+  }
+
+  /// Selects single sample or band limited impulses.
+  void setBandLimited (bool shouldBandLimit) noexcept { bandLimited = shouldBandLimit; }
+
+  /// Clears any band limited impulse still carried into the next block.
+  void reset() noexcept { carry.fill (0.0f); }
+
+  /// Adds the impulses due in the next numSamples to output, with
+  /// amplitudes uniform in [-gain, gain). Only the impulses' samples are
+  /// written, so output is normally cleared beforehand.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    if (bandLimited)
+      addCarry (output, numSamples);
+    if (meanInterval <= 0.0)
+      return;
+    while (samplesToNext < (double) numSamples) {
+      auto amplitude = gain * (2.0f * random.nextFloat() - 1.0f);
+      if (bandLimited)
+        addBandLimitedImpulse (output, numSamples, samplesToNext, amplitude);
+      else
+        output[(int) samplesToNext] += amplitude;
+      samplesToNext += drawInterval();
+    }
+    samplesToNext -= numSamples;
+  }
+
+private:
+  static constexpr int numTaps = WindowedSincKernel::numTaps;
+
+  /// Draws an exponentially distributed interval with a mean of meanInterval samples.
+  double drawInterval() noexcept
+  {
+    return -std::log (1.0 - random.nextDouble()) * meanInterval;
+  }
+
+  /// Adds the tails of the last block's impulses and moves the carry along
+  /// by numSamples.
+  void addCarry (float* output, int numSamples) noexcept
+  {
+    auto numCarried = jmin (numSamples, numTaps);
+    for (int i = 0; i < numCarried; ++i)
+      output[i] += carry[(size_t) i];
+    std::copy (carry.begin() + numCarried, carry.end(), carry.begin());
+    std::fill (carry.end() - numCarried, carry.end(), 0.0f);
+  }
+
+  void addBandLimitedImpulse (float* output, int numSamples, double time, float amplitude) noexcept
+  {
+    auto whole = (int) time;
+    WindowedSincKernel::get().forEachTap ((float) (time - whole), [&] (int tap, float coefficient)
+    {
+      auto index = whole + tap;
+      if (index < numSamples)
+        output[index] += amplitude * coefficient;
+      else
+        carry[(size_t) (index - numSamples)] += amplitude * coefficient;
+    });
+  }
+
+  Random random;
+  /// The average number of samples between impulses, 0 when stopped.
+  double meanInterval = 0.0;
+  /// The wait in samples from the start of the next block to the next impulse.
+  double samplesToNext = 0.0;
+  bool bandLimited = false;
+  /// The band limited impulse samples that fall into the next block.
+  std::array<float, numTaps> carry {};
+};
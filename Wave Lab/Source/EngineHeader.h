@@ -0,0 +1,25 @@
+//==============================================================================
+// EngineHeader.h
+// The JUCE modules the GUI-free engine is built on.
+//==============================================================================
+
+#pragma once
+
+/// The engine's sources include this rather than the app's JuceHeader.h,
+/// which pulls in every GUI module, so the engine (see WaveEngine) builds
+/// and links with only juce_core, juce_audio_basics, juce_audio_formats and
+/// juce_dsp, e.g. as the CMake WaveEngine library on a headless Linux
+/// machine. In the Projucer app the module settings come from AppConfig.h;
+/// in the CMake build they are compile definitions.
+#ifndef JUCE_GLOBAL_MODULE_SETTINGS_INCLUDED
+ #include "../JuceLibraryCode/AppConfig.h"
+#endif
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+
+#if ! DONT_SET_USING_JUCE_NAMESPACE
+ using namespace juce;
+#endif
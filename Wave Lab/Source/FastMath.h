@@ -0,0 +1,198 @@
+
+//==============================================================================
+// FastMath.h
+// Polynomial sin, cos and tanh approximations at selectable accuracies.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// FastMath approximates sin(), cos() and tanh() with minimax polynomials
+/// and rational functions, for float, double and dsp::SIMDRegister<float>
+/// arguments. Each function takes an Accuracy tier so a generator can pick
+/// the cheapest one that is good enough for it:
+///
+///   tier     sin / cos                            tanh
+///   Exact    std::sin / std::cos                  std::tanh
+///   Bits24   degree 9, relative error < 5.4e-9    13/6 rational, error < 4e-7
+///   Bits16   degree 7, relative error < 9.4e-7    7/6 rational, error < 2.7e-6
+///
+/// The sin/cos errors are those of the polynomial after the argument is
+/// reduced to [-pi/2, pi/2] and are relative, so they also hold for tiny
+/// results (e.g. the denominator of a Dirichlet kernel). In double they hold
+/// as stated. In float the reduction's rounding adds to them: measured over
+/// |x| < 3000 the absolute errors are 2e-7 (Bits24) and 1.1e-6 (Bits16).
+/// The reduction subtracts multiples of a two part pi (Cody and Waite). The
+/// tanh errors are absolute and were measured in float. The coefficients
+/// were fitted with the Remez exchange algorithm. With the loops vectorized
+/// (-O3 with AVX2) the float sin costs 0.5 to 0.65 ns against 9.6 ns for
+/// std::sin.
+
+namespace FastMath
+{
+  enum class Accuracy { Exact, Bits24, Bits16 };
+
+  namespace detail
+  {
+    using SIMDFloat = dsp::SIMDRegister<float>;
+
+    template <typename Type> struct ScalarOf { using type = Type; };
+    template <> struct ScalarOf<SIMDFloat> { using type = float; };
+
+    /// Returns a value of Type with every element set to x.
+    template <typename Type>
+    Type broadcast (typename ScalarOf<Type>::type x) noexcept { return x; }
+    template <>
+    inline SIMDFloat broadcast<SIMDFloat> (float x) noexcept { return SIMDFloat::expand (x); }
+
+    /// Rounds to the nearest integer. Adding and subtracting 1.5 * 2^23
+    /// (1.5 * 2^52 for doubles) leaves the nearest integer for |x| < 2^22
+    /// (2^51), in two adds rather than a call to std::nearbyint.
+    inline float roundToNearest (float x) noexcept { return (x + 12582912.0f) - 12582912.0f; }
+    inline double roundToNearest (double x) noexcept { return (x + 6755399441055744.0) - 6755399441055744.0; }
+    inline SIMDFloat roundToNearest (SIMDFloat x) noexcept
+    {
+      const auto magic = SIMDFloat::expand (12582912.0f);
+      return (x + magic) - magic;
+    }
+
+    inline float clampTo (float x, float limit) noexcept { return jlimit (-limit, limit, x); }
+    inline double clampTo (double x, double limit) noexcept { return jlimit (-limit, limit, x); }
+    inline SIMDFloat clampTo (SIMDFloat x, float limit) noexcept
+    {
+      return SIMDFloat::min (SIMDFloat::max (x, SIMDFloat::expand (-limit)), SIMDFloat::expand (limit));
+    }
+
+    inline float divide (float a, float b) noexcept { return a / b; }
+    inline double divide (double a, double b) noexcept { return a / b; }
+    /// SIMDRegister has no division, so it is done lane by lane.
+    inline SIMDFloat divide (SIMDFloat a, SIMDFloat b) noexcept
+    {
+      alignas (SIMDFloat::SIMDRegisterSize) float x[SIMDFloat::SIMDNumElements], y[SIMDFloat::SIMDNumElements];
+      a.copyToRawArray (x);
+      b.copyToRawArray (y);
+      for (size_t i = 0; i < SIMDFloat::SIMDNumElements; ++i)
+        x[i] /= y[i];
+      return SIMDFloat::fromRawArray (x);
+    }
+
+    /// Applies a scalar function to every lane.
+    template <typename Function>
+    SIMDFloat forEachLane (SIMDFloat x, Function&& function) noexcept
+    {
+      alignas (SIMDFloat::SIMDRegisterSize) float lanes[SIMDFloat::SIMDNumElements];
+      x.copyToRawArray (lanes);
+      for (auto& lane : lanes)
+        lane = function (lane);
+      return SIMDFloat::fromRawArray (lanes);
+    }
+
+    inline float exactSin (float x) noexcept { return std::sin (x); }
+    inline double exactSin (double x) noexcept { return std::sin (x); }
+    inline SIMDFloat exactSin (SIMDFloat x) noexcept { return forEachLane (x, [] (float v) { return std::sin (v); }); }
+    inline float exactCos (float x) noexcept { return std::cos (x); }
+    inline double exactCos (double x) noexcept { return std::cos (x); }
+    inline SIMDFloat exactCos (SIMDFloat x) noexcept { return forEachLane (x, [] (float v) { return std::cos (v); }); }
+    inline float exactTanh (float x) noexcept { return std::tanh (x); }
+    inline double exactTanh (double x) noexcept { return std::tanh (x); }
+    inline SIMDFloat exactTanh (SIMDFloat x) noexcept { return forEachLane (x, [] (float v) { return std::tanh (v); }); }
+
+    /// pi split into a part with few significant bits, so k * piHigh is
+    /// exact for |k| < 2^15, and the remainder.
+    constexpr double piHigh = 3.140625;
+    constexpr double piLow = 9.67653589793e-4;
+
+    /// sin(r) for r in [-pi/2, pi/2] as r * P(r^2).
+    template <Accuracy accuracy, typename Type>
+    Type sinPolynomial (Type r) noexcept
+    {
+      using Scalar = typename ScalarOf<Type>::type;
+      auto r2 = r * r;
+      Type p;
+      if (accuracy == Accuracy::Bits16) {
+        p = r2 * (Scalar) -1.848814029032e-4 + (Scalar) 8.311899801460e-3;
+        p = p * r2 + (Scalar) -1.666555409276e-1;
+        p = p * r2 + (Scalar) 9.999990608990e-1;
+      }
+      else {
+        p = r2 * (Scalar) 2.601903067743e-6 + (Scalar) -1.980741872747e-4;
+        p = p * r2 + (Scalar) 8.333025138970e-3;
+        p = p * r2 + (Scalar) -1.666665668401e-1;
+        p = p * r2 + (Scalar) 9.999999946860e-1;
+      }
+      return r * p;
+    }
+
+    /// sin(x) where x = k * pi + r, with the sign of (-1)^k.
+    template <Accuracy accuracy, typename Type>
+    Type reducedSin (Type x, Type k, Type offset) noexcept
+    {
+      using Scalar = typename ScalarOf<Type>::type;
+      auto r = x - k * (Scalar) piHigh - k * (Scalar) piLow + offset;
+      // half of k is whole for even k and off by 1/2 for odd k
+      auto half = k * (Scalar) 0.5;
+      auto odd = half - roundToNearest (half);
+      auto sign = odd * odd * (Scalar) -8 + (Scalar) 1;
+      return sinPolynomial<accuracy> (r) * sign;
+    }
+  }
+
+  /// Returns sin(x).
+  template <Accuracy accuracy, typename Type>
+  Type sin (Type x) noexcept
+  {
+    using Scalar = typename detail::ScalarOf<Type>::type;
+    if (accuracy == Accuracy::Exact)
+      return detail::exactSin (x);
+    auto k = detail::roundToNearest (x * (Scalar) (1.0 / MathConstants<double>::pi));
+    return detail::reducedSin<accuracy> (x, k, detail::broadcast<Type> (0));
+  }
+
+  /// Returns cos(x), as sin(x + pi/2) with pi/2 added after the reduction.
+  template <Accuracy accuracy, typename Type>
+  Type cos (Type x) noexcept
+  {
+    using Scalar = typename detail::ScalarOf<Type>::type;
+    if (accuracy == Accuracy::Exact)
+      return detail::exactCos (x);
+    auto k = detail::roundToNearest (x * (Scalar) (1.0 / MathConstants<double>::pi) + (Scalar) 0.5);
+    return detail::reducedSin<accuracy> (x, k, detail::broadcast<Type> ((Scalar) MathConstants<double>::halfPi));
+  }
+
+  /// Returns tanh(x). The rational approximations are clamped to the range
+  /// beyond which tanh(x) rounds to +/-1.
+  template <Accuracy accuracy, typename Type>
+  Type tanh (Type x) noexcept
+  {
+    using Scalar = typename detail::ScalarOf<Type>::type;
+    if (accuracy == Accuracy::Exact)
+      return detail::exactTanh (x);
+    Type p, q;
+    if (accuracy == Accuracy::Bits16) {
+      x = detail::clampTo (x, (Scalar) 8);
+      auto x2 = x * x;
+      p = x2 * (Scalar) 3.4113968487e-6 + (Scalar) 2.1602774993e-3;
+      p = p * x2 + (Scalar) 1.2167330981e-1;
+      p = (p * x2 + (Scalar) 9.9998896343e-1) * x;
+      q = x2 * (Scalar) 1.3001035164e-4 + (Scalar) 2.0517310824e-2;
+      q = q * x2 + (Scalar) 4.5497152641e-1;
+      q = q * x2 + (Scalar) 1;
+    }
+    else {
+      // the coefficients of Eigen's fast float tanh
+      x = detail::clampTo (x, (Scalar) 7.90531110763549805);
+      auto x2 = x * x;
+      p = x2 * (Scalar) -2.76076847742355e-16 + (Scalar) 2.00018790482477e-13;
+      p = p * x2 + (Scalar) -8.60467152213735e-11;
+      p = p * x2 + (Scalar) 5.12229709037114e-08;
+      p = p * x2 + (Scalar) 1.48572235717979e-05;
+      p = p * x2 + (Scalar) 6.37261928875436e-04;
+      p = (p * x2 + (Scalar) 4.89352455891786e-03) * x;
+      q = x2 * (Scalar) 1.19825839466702e-06 + (Scalar) 1.18534705686654e-04;
+      q = q * x2 + (Scalar) 2.26843463243900e-03;
+      q = q * x2 + (Scalar) 4.89352518554385e-03;
+    }
+    return detail::divide (p, q);
+  }
+}
@@ -4,7 +4,7 @@
 #include "MainApplication.h"
 
 MainComponent::MainComponent()
-: deviceManager (MainApplication::getApp().audioDeviceManager), audioVisualizer(2) {
+: deviceManager (MainApplication::getApp().audioDeviceManager) {
    addAndMakeVisible(playButton);
    playButton.addListener(this);
    drawPlayButton(playButton, true);
@@ -41,28 +41,56 @@ MainComponent::MainComponent()
    addAndMakeVisible(waveformMenu);
    waveformMenu.setTextWhenNothingSelected("Waveforms");
 //   StringArray noise {"White", "Brown", "Dust"};
-   waveformMenu.addItemList(noise, WhiteNoise);
+   waveformMenu.addItemList(noise, WaveEngine::WhiteNoise);
    waveformMenu.addSeparator();
 
-   waveformMenu.addItem("Sine", SineWave);
+   waveformMenu.addItem("Sine", WaveEngine::SineWave);
    waveformMenu.addSeparator();
 
    StringArray LF {"LF Impulse", "LF Square", "LF Saw", "LF Triangle"};
-   waveformMenu.addItemList(LF, LF_ImpulseWave);
+   waveformMenu.addItemList(LF, WaveEngine::LF_ImpulseWave);
    waveformMenu.addSeparator();
 
    StringArray BL {"BL Impulse", "BL Square", "BL Saw", "BL Triangle"};
-   waveformMenu.addItemList(BL, BL_ImpulseWave);
+   waveformMenu.addItemList(BL, WaveEngine::BL_ImpulseWave);
+   waveformMenu.addSeparator();
+
+   StringArray BLF {"BL Fast Square", "BL Fast Saw", "BL Fast Pulse", "BL Fast Triangle", "BL Fast BLIT Saw"};
+   waveformMenu.addItemList(BLF, WaveEngine::BLF_SquareWave);
    waveformMenu.addSeparator();
 
 
    StringArray WT {"WT SineWave", "WT Impulse", "WT Square", "WT Saw", "WT Triangle"};
-   waveformMenu.addItemList(WT, WT_SineWave);
+   waveformMenu.addItemList(WT, WaveEngine::WT_SineWave);
    waveformMenu.addSeparator();
 
    waveformMenu.addListener(this);
 
    addAndMakeVisible(audioVisualizer);
+   addAndMakeVisible(spectrumDisplay);
+
+   addAndMakeVisible(cpuLabel);
+   cpuLabel.setJustificationType(Justification::centredRight);
+   addAndMakeVisible(cpuUsage);
+   cpuUsage.setJustificationType(Justification::centredRight);
+
+   addAndMakeVisible(profileButton);
+   profileButton.setClickingTogglesState(true);
+   profileButton.addListener(this);
+   // drawn over the visualizer, hidden until the profile button is pressed
+   addChildComponent(profilerOverlay);
+
+   addAndMakeVisible(qualityButton);
+   qualityButton.setToggleState(true, dontSendNotification);
+   qualityButton.addListener(this);
+   engine.setGovernorEnabled(true);
+
+   // the wavetables are built in the background, the WT_* waveforms are
+   // silent until they are ready.
+   engine.setInterpolation(WavetableOscillator::CubicHermite);
+   createWaveTables();
+   startTimer(500);
+
    this->deviceManager.addAudioCallback(&audioSourcePlayer);
 
 }
@@ -106,9 +134,16 @@ void MainComponent::resized() {
    freqSlider.setBounds(lineTwo);
 
    auto insideArea = area.withTrimmedBottom(24).withTrimmedTop(8);
-   audioVisualizer.setBounds(insideArea);
+   audioVisualizer.setBounds(insideArea.removeFromTop(insideArea.getHeight() / 2));
+   spectrumDisplay.setBounds(insideArea);
+   profilerOverlay.setBounds(audioVisualizer.getBounds().removeFromTop(174).removeFromRight(360));
    auto bottomLine = area.removeFromBottom(24);
    bottomLine.removeFromRight(8);
+   cpuUsage.setBounds(bottomLine.removeFromRight(66));
+   cpuLabel.setBounds(bottomLine.removeFromRight(36));
+   profileButton.setBounds(bottomLine.removeFromLeft(72).reduced(0, 2));
+   bottomLine.removeFromLeft(8);
+   qualityButton.setBounds(bottomLine.removeFromLeft(140));
 
 }
 
@@ -150,31 +185,29 @@ void MainComponent::buttonClicked (Button *button) {
    } else if (button == &settingsButton) {
       openAudioSettings();
 //      std::cout << "settings button" <<std::endl;
+   } else if (button == &profileButton) {
+      profilerOverlay.setVisible(profileButton.getToggleState());
+      updateProfilerOverlay();
+   } else if (button == &qualityButton) {
+      engine.setGovernorEnabled(qualityButton.getToggleState());
    }
 }
 
 void MainComponent::sliderValueChanged (Slider *slider) {
    if (slider == &levelSlider) {
-      level = levelSlider.getValue();
+      changeParameter(WaveEngine::LevelParameter, levelSlider.getValue());
 //      std::cout << "levelslider" <<std::endl;
    } else if (slider == &freqSlider) {
-      freq = freqSlider.getValue();
-      phaseDelta = freq/srate;
+      changeParameter(WaveEngine::FrequencyParameter, freqSlider.getValue());
 //      std::cout << "freqslider" <<std::endl;
-      for (auto & index:oscillators) {
-         index->setFrequency(freq, srate);
-      }
    }
 }
 
 void MainComponent::comboBoxChanged (ComboBox *menu) {
-   waveformId = static_cast<MainComponent::WaveformId>(menu->getSelectedId());
    if (menu == &waveformMenu) {
-      if (waveformMenu.getSelectedIdAsValue() == WhiteNoise || waveformMenu.getSelectedIdAsValue() == BrownNoise) {
-         freqSlider.setEnabled(false);
-      } else {
-         freqSlider.setEnabled(true);
-      }
+      auto waveformId = static_cast<WaveEngine::WaveformId>(menu->getSelectedId());
+      changeParameter(WaveEngine::WaveformParameter, waveformId);
+      freqSlider.setEnabled(WaveEngine::hasFrequency(waveformId));
    }
 }
 
@@ -183,24 +216,24 @@ void MainComponent::comboBoxChanged (ComboBox *menu) {
 //==============================================================================
 void MainComponent::timerCallback() {
    cpuUsage.setText(String(deviceManager.getCpuUsage() * 100, 2, false) + " %", dontSendNotification);
+   engine.collectGarbage();
+   updateProfilerOverlay();
 }
 
 //==============================================================================
 // AudioSource overrides
 //==============================================================================
 void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate) {
-   srate = sampleRate;
-   phase = 0;
-   phaseDelta = freq/srate;
-   // specifically for sine wave
-//   phaseDelta = srate * 2.0 * MathConstants<double>::pi;
-   audioVisualizer.setBufferSize(samplesPerBlockExpected);
    //display 8 blocks concurrently
-   audioVisualizer.setSamplesPerBlock(8);
+   audioVisualizer.setViewLength(samplesPerBlockExpected * 8);
+   spectrumDisplay.setSampleRate(sampleRate);
+   // one dust and colored noise stream per output channel
+   auto* device = deviceManager.getCurrentAudioDevice();
+   auto numChannels = (device != nullptr) ? device->getActiveOutputChannels().countNumberOfSetBits() : 2;
+   // different noise every time the app runs
+   engine.prepare(sampleRate, numChannels, Random::getSystemRandom().nextInt64());
+   profiler.prepare(sampleRate);
    createWaveTables();
-   for (auto & index:oscillators) {
-      index->setFrequency(freq, srate);
-   }
 }
 
 void MainComponent::releaseResources() {
@@ -208,62 +241,54 @@ void MainComponent::releaseResources() {
 }
 
 void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) {
-  bufferToFill.clearActiveBufferRegion();
-
-  switch (waveformId) {
-    case WhiteNoise:      whiteNoise(bufferToFill);   break;
-    case DustNoise:       dust(bufferToFill);         break;
-    case BrownNoise:      brownNoise(bufferToFill);   break;
-    case SineWave:        sineWave(bufferToFill);     break;
-    case LF_ImpulseWave:  LF_impulseWave(bufferToFill);  break;
-    case LF_SquareWave:   LF_squareWave(bufferToFill);   break;
-    case LF_SawtoothWave: LF_sawtoothWave(bufferToFill); break;
-    case LF_TriangeWave:  LF_triangleWave(bufferToFill); break;
-    case BL_ImpulseWave:  BL_impulseWave(bufferToFill);  break;
-    case BL_SquareWave:   BL_squareWave(bufferToFill);   break;
-    case BL_SawtoothWave: BL_sawtoothWave(bufferToFill); break;
-    case BL_TriangeWave:  BL_triangleWave(bufferToFill); break;
-     case WT_SineWave:
-    case WT_ImpulseWave:
-    case WT_SquareWave:
-    case WT_SawtoothWave:
-    case WT_TriangleWave:
-      WT_wave(bufferToFill);
-      break;
-    case Empty:
-      break;
+  auto startTicks = BlockProfiler::startBlock();
+  // the engine overwrites every channel, so the buffer is not cleared first
+  float* channels[WaveEngine::maxChannels];
+  auto numChannels = jmin(bufferToFill.buffer->getNumChannels(), WaveEngine::maxChannels);
+  for (int chan = 0; chan < numChannels; ++chan) {
+    channels[chan] = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
   }
-  audioVisualizer.pushBuffer(bufferToFill);
-
+  engine.process(channels, numChannels, bufferToFill.numSamples);
+  for (int chan = numChannels; chan < bufferToFill.buffer->getNumChannels(); ++chan) {
+    bufferToFill.buffer->clear(chan, bufferToFill.startSample, bufferToFill.numSamples);
+  }
+  audioVisualizer.pushSamples(channels, numChannels, bufferToFill.numSamples);
+  spectrumDisplay.pushSamples(channels, numChannels, bufferToFill.numSamples);
+  profiler.endBlock(startTicks, bufferToFill.numSamples, engine.getWaveform());
 }
 
 //==============================================================================
 // Audio Utilities
 //==============================================================================
 
-double MainComponent::phasor() {
-  return fmod(phase + phaseDelta, 1);
-
-}
-
-float MainComponent::ranSamp() {
-   // returns rand from 0 <->1
-   return (random.Random::nextFloat()) *2 - 1;
-}
-
-float MainComponent::ranSamp(const float mul) {
-  return (ranSamp() * mul);
-}
-
-float MainComponent::lowPass(const float value, const float prevout, const float alpha) {
-   auto output = prevout + alpha * (value - prevout);
-   return output;
+void MainComponent::updateProfilerOverlay() {
+   auto waveformId = static_cast<WaveEngine::WaveformId>(waveformMenu.getSelectedId());
+   profilerOverlay.update(waveformId, engine.isGovernorEnabled() ? (int) engine.getQuality() : -1);
 }
 
 bool MainComponent::isPlaying() {
    return audioSourcePlayer.getCurrentSource() != nullptr;
 }
 
+// While stopped the audio thread does not call the engine, so the change is
+// made directly rather than left in the queue.
+void MainComponent::changeParameter (WaveEngine::Parameter parameter, double value) {
+   if (isPlaying()) {
+      engine.post(parameter, value);
+      return;
+   }
+   switch (parameter) {
+      case WaveEngine::LevelParameter:     engine.setLevel(value);     break;
+      case WaveEngine::FrequencyParameter: engine.setFrequency(value); break;
+      case WaveEngine::WaveformParameter:
+         engine.setWaveform((WaveEngine::WaveformId) (int) value);
+         break;
+      case WaveEngine::InterpolationParameter:
+         engine.setInterpolation((WavetableOscillator::Interpolation) (int) value);
+         break;
+   }
+}
+
 void MainComponent::openAudioSettings() {
    auto devComp = std::make_unique<AudioDeviceSelectorComponent>(this->deviceManager,0,2,0,2,true, false, true, false);
    DialogWindow::LaunchOptions dw;
@@ -277,379 +302,8 @@ void MainComponent::openAudioSettings() {
 
 }
 
+// The tables are independent of the sample rate (the oscillators choose their
+// band limited level from it), so they are only rebuilt if tableSize changes.
 void MainComponent::createWaveTables() {
-  createSineTable(sineTable);
-  oscillators.push_back(std::make_unique<WavetableOscillator>(sineTable));
-  createImpulseTable(impulseTable);
-  oscillators.push_back(std::make_unique<WavetableOscillator>(impulseTable));
-  createSquareTable(squareTable);
-  oscillators.push_back(std::make_unique<WavetableOscillator>(squareTable));
-  createSawtoothTable(sawtoothTable);
-  oscillators.push_back(std::make_unique<WavetableOscillator>(sawtoothTable));
-  createTriangleTable(triangleTable);
-  oscillators.push_back(std::make_unique<WavetableOscillator>(triangleTable));
-}
-
-//==============================================================================
-// Noise
-//==============================================================================
-
-// White Noise
-
-void MainComponent::whiteNoise (const AudioSourceChannelInfo& bufferToFill) {
-   // process every channel of data
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan) {
-      // get the pointer to the first sample in the channel to process
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      // iterate the pointer over all the samples in the channel data
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-         channelData[i] = ranSamp(level); // assign a value to the current sample
-      }
-   }
-}
-
-
-void MainComponent::brownNoise (const AudioSourceChannelInfo& bufferToFill) {
-   // process every channel of data
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan) {
-      // get the pointer to the first sample in the channel to process
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      // iterate the pointer over all the samples in the channel data
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-         channelData[i] = ranSamp(level); // assign a value to the current sample
-         //using white noise, use low pass filter
-         channelData[i] = lowPass(channelData[i], channelData[i - 1], 0.5);
-      }
-   }
-}
-// Generates random uniform samples with a probability of freq/srate across all channels
-void MainComponent::dust (const AudioSourceChannelInfo& bufferToFill) {
-      // process every channel of data
-      auto probability = freq/(srate * bufferToFill.buffer->getNumChannels());
-      for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan) {
-         // get the pointer to the first sample in the channel to process
-         float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-         // iterate the pointer over all the samples in the channel data
-         for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-            if (random.nextDouble() < probability) {
-               channelData[i] = ranSamp(level); // assign a value to the current sample
-            }
-         }
-      }
-
-}
-
-//==============================================================================
-// Sine Wave
-//==============================================================================
-
-void MainComponent::sineWave (const AudioSourceChannelInfo& bufferToFill)
-{
-   double initialPhase = phase;
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan)
-   {
-      phase = initialPhase;
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      for (int i = 0; i < bufferToFill.numSamples ; ++i)
-      {
-         channelData[i] = (float) std::sin(TwoPi * phase) * level;
-         phase += phaseDelta;
-      }
-   }
-}
-
-//==============================================================================
-// Low Frequency Waveforms
-//==============================================================================
-
-/// Impulse wave
-void MainComponent::LF_impulseWave (const AudioSourceChannelInfo& bufferToFill) {
-//current - prev -->neg --> started a new period
-   double initialPhase = phase;
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan)
-   {
-      phase = initialPhase;
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-         auto prev = phasor();
-         phase += phaseDelta;
-         auto current = phasor();
-         if (current - prev < 0) {
-         // if phasor decrease -> output level
-            channelData[i] = (float) level;
-         }
-      }
-   }
-}
-
-
-/// Square wave
-
-void MainComponent::LF_squareWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan)
-   {
-      phase = initialPhase;
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-
-         if (phasor() < .5) {
-            channelData[i] = (float) -1*level;
-         } else {
-            channelData[i] = (float) level;
-         }
-         phase += phaseDelta;
-      }
-   }
-}
-
-/// Sawtooth wave
-
-void MainComponent::LF_sawtoothWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan)
-   {
-      phase = initialPhase;
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-         //phasor is scaled by 2 and offset by 1
-         channelData[i] = (float) (phasor() * 2 - 1) * level;
-         phase += phaseDelta;
-      }
-   }
-}
-
-/// Triangle wave
-
-void MainComponent::LF_triangleWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   for (int chan = 0; chan < bufferToFill.buffer->getNumChannels(); ++chan)
-   {
-      phase = initialPhase;
-      float* const channelData = bufferToFill.buffer->getWritePointer(chan, bufferToFill.startSample);
-      for (int i = 0; i < bufferToFill.numSamples ; ++i) {
-            // phasor in first half
-         if (phasor() < .5) {
-            channelData[i] = (float) (phasor() * 4 - 1) * level;
-         } else {
-            channelData[i] = (float) ((phasor() * -1 * 4 + 3) *level);
-         }
-         phase += phaseDelta;
-      }
-   }
-}
-
-//==============================================================================
-// Band Limited Waveforms
-//==============================================================================
-
-/// Impulse (pulse) wave
-/// Synthesized by summing sin() over frequency and all its harmonics at equal
-/// amplitude. To make it band limited only include harmonics that are at or
-/// below the nyquist limit.
-//nyquist limit = highest freq can represent
-//sampling rate/ 2
-void MainComponent::BL_impulseWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   phase = initialPhase;
-   float* const chan0 = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-   float* const chan1 = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-   for (int i = 0; i < bufferToFill.numSamples; ++i)
-   {
-      if (freq != 0) {
-         auto numHarmonic = srate/2/freq;
-         for (auto u = 1; u <= numHarmonic; ++u) {
-            chan0[i] += (float) std::sin(TwoPi * phasor() * u) * (level/numHarmonic);
-         }
-         phase += phaseDelta;
-      }
-   }
-   std::memcpy(chan1, chan0, bufferToFill.numSamples * sizeof(float));
-
-}
-
-/// Square wave
-/// Synthesized by summing sin() over all ODD harmonics at 1/harmonic amplitude.
-/// To make it band limited only include harmonics that are at or below the
-/// nyquist limit.
-void MainComponent::BL_squareWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   phase = initialPhase;
-   float* const chan0 = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-   float* const chan1 = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-   for (int i = 0; i < bufferToFill.numSamples; ++i)
-   {
-      if (freq != 0) {
-         auto numHarmonic = srate/2/freq;
-         for (auto u = 1; u <= numHarmonic; ++u) {
-            if (u % 2 != 0) {
-               chan0[i] += (float) std::sin(TwoPi * phasor() * u) * (level/u);
-            }
-         }
-      }
-      phase += phaseDelta;
-   }
-   std::memcpy(chan1, chan0, bufferToFill.numSamples * sizeof(float));
-
-}
-
-/// Sawtooth wave
-/// Synthesized by summing sin() over all harmonics at 1/harmonic amplitude. To make
-/// it band limited only include harmonics that are at or below the nyquist limit.
-void MainComponent::BL_sawtoothWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   phase = initialPhase;
-   float* const chan0 = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-   float* const chan1 = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-   if (freq == 0) {
-      return;
-   }
-   for (int i = 0; i < bufferToFill.numSamples; ++i)
-   {
-      if (freq != 0) {
-         auto numHarmonic = srate/2/freq;
-         for (auto u = 1; u <= numHarmonic; ++u) {
-            chan0[i] += (float) std::sin(TwoPi * phasor() * u) * (level/u);
-         }
-         phase += phaseDelta;
-      }
-   }
-   std::memcpy(chan1, chan0, bufferToFill.numSamples * sizeof(float));
-}
-
-/// Triangle wave
-/// Synthesized by summing sin() over all ODD harmonics at 1/harmonic**2 amplitude.
-/// To make it band limited only include harmonics that are at or below the
-/// Nyquist limit.
-void MainComponent::BL_triangleWave (const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   phase = initialPhase;
-   float* const chan0 = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-   float* const chan1 = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-   if (freq != 0) {
-
-      for (int i = 0; i < bufferToFill.numSamples; ++i)
-      {
-         auto numHarmonic = srate/2/freq;
-         if (freq != 0) {
-            for (auto u = 1; u <= numHarmonic; ++u) {
-               if (u % 2 != 0) {
-                  chan0[i] += (float) std::sin(TwoPi * phasor() * u) * (level/pow(u,2));
-               }
-            }
-         }
-         phase += phaseDelta;
-      }
-      std::memcpy(chan1, chan0, bufferToFill.numSamples * sizeof(float));
-   }
-}
-
-//==============================================================================
-// WaveTable Synthesis
-//==============================================================================
-
-// The audio block loop
-void inline MainComponent::WT_wave(const AudioSourceChannelInfo& bufferToFill) {
-   double initialPhase = phase;
-   phase = initialPhase;
-   float* const chan0 = bufferToFill.buffer->getWritePointer(0, bufferToFill.startSample);
-   float* const chan1 = bufferToFill.buffer->getWritePointer(1, bufferToFill.startSample);
-
-   for (int i = 0; i < bufferToFill.numSamples; ++i) {
-      chan0[i] = oscillators[waveformId-WT_START]->getNextSample() *level;
-   }
-   std::memcpy(chan1, chan0, bufferToFill.numSamples * sizeof(float));
-}
-
-
-// Create a sine wave table
-void MainComponent::createSineTable(AudioSampleBuffer& waveTable) {
-  waveTable.setSize (1, tableSize + 1);
-  waveTable.clear();
-  auto* samples = waveTable.getWritePointer (0);
-  auto phase = 0.0;
-  auto phaseDelta = MathConstants<double>::twoPi / (double) (tableSize - 1);
-  for (auto i = 0; i < tableSize; ++i) {
-    samples[i] += std::sin(phase);
-    phase += phaseDelta;
-  }
-  samples[tableSize] = samples[0];
-}
-
-
-void MainComponent::createImpulseTable(AudioSampleBuffer& waveTable) {
-   waveTable.setSize (1, tableSize + 1);
-   waveTable.clear();
-   auto* samples = waveTable.getWritePointer (0);
-   auto phase = 0.0;
-   for (auto i = 0; i < tableSize; ++i) {
-      auto numHarmonic = srate/2;
-//      auto numHarmonic = srate/2/freq;
-      for (auto u = 1; u <= numHarmonic; ++u) {
-         samples[i] += std::sin(phase);
-      }
-      samples[i] *= 1/numHarmonic;
-      phase += phaseDelta;
-   }
-   //keep this
-   samples[tableSize] = samples[0];
-}
-
-// Create a square wave table
-void MainComponent::createSquareTable(AudioSampleBuffer& waveTable) {
-   waveTable.setSize (1, tableSize + 1);
-   waveTable.clear();
-   auto* samples = waveTable.getWritePointer (0);
-   auto phase = 0.0;
-   auto phaseDelta = MathConstants<double>::twoPi / (double) (tableSize - 1);
-   for (auto i = 0; i < tableSize; ++i) {
-         auto numHarmonic = srate/2;
-         for (auto u = 1; u <= numHarmonic; ++u) {
-            if (u % 2 != 0) {
-               samples[i] += (float) std::sin(u * phase) / u;
-            }
-         }
-         phase += phaseDelta;
-   }
-   //keep this
-   samples[tableSize] = samples[0];
-}
-
-// Create a sawtooth wave table
-void MainComponent::createSawtoothTable(AudioSampleBuffer& waveTable) {
-   waveTable.setSize (1, tableSize + 1);
-   waveTable.clear();
-   auto* samples = waveTable.getWritePointer (0);
-   auto phase = 0.0;
-   auto phaseDelta = MathConstants<double>::twoPi / (double) (tableSize - 1);
-   for (auto i = 0; i < tableSize; ++i) {
-      auto numHarmonic = srate/2;
-      for (auto u = 1; u <= numHarmonic; ++u) {
-         samples[i] += (float) std::sin(u * phase) / u;
-      }
-      samples[i] = samples[i]/1.6;
-      phase += phaseDelta;
-      }
-   //keep this
-   samples[tableSize] = samples[0];
-}
-
-// Create a triagle wave table
-void MainComponent::createTriangleTable(AudioSampleBuffer& waveTable) {
-   waveTable.setSize (1, tableSize + 1);
-   waveTable.clear();
-   auto* samples = waveTable.getWritePointer (0);
-   auto phase = 0.0;
-   auto phaseDelta = MathConstants<double>::twoPi / (double) (tableSize - 1);
-   for (auto i = 0; i < tableSize; ++i) {
-      auto numHarmonic = srate/2;
-      for (auto u = 1; u <= numHarmonic; ++u) {
-         if (u % 2 != 0) {
-            samples[i] += (float) std::sin(u * phase) / pow(u, 2);
-         }
-      }
-      phase += phaseDelta;
-   }
-   //keep this
-   samples[tableSize] = samples[0];
+  engine.requestWavetables(tableSize);
 }
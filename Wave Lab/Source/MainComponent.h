@@ -5,7 +5,11 @@
 
 #pragma once
 
-#include "WavetableOscillator.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "WaveEngine.h"
+#include "WaveformDisplay.h"
+#include "SpectrumDisplay.h"
+#include "ProfilerOverlay.h"
 
 /// MainComponent provides the app's user controls and content. NOTE: this
 /// must inherit from three listener classes to respond to user interactions
@@ -17,16 +21,18 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// * Add and make visible all subcomponents.
   /// * Add the main component as a listener to all the buttons and sliders.
   /// * The ComboBox (menu) should display "Waveforms" if nothing is selected in the menu.
-  /// * The menu has 5 sections, use ComboBox::addItemList() to add each section.
+  /// * The menu has 6 sections, use ComboBox::addItemList() to add each section.
   ///   After each section add a separator item (See ComboBox::addSeparator())
-  /// - The first section contains the strings "White", "Brown", "Dust" and starts
-  /// with the id WhiteNoise.
+  /// - The first section contains the strings "White", "Brown", "Dust", "Gaussian",
+  /// "Pink", "Blue", "Violet" and starts with the id WhiteNoise.
   /// - The second section contains just the string "Sine" with the id SineWave.
   /// - The third section contains "LF Impulse", "LF Square", "LF Saw", "LF Triangle" and
   /// its ids start with LF_ImpulseWave.
   /// - The fourth section contains "BL Impulse", "BL Square", "BL Saw", "BL Triangle"
   /// and starts with BL_ImpulseWave.
-  /// - The fifth section contains "WT Sine", "WT Impulse", "WT Square", "WT Saw", "WT Triangle"
+  /// - The fifth section contains "BL Fast Square", "BL Fast Saw", "BL Fast Pulse",
+  /// "BL Fast Triangle", "BL Fast BLIT Saw" and starts with BLF_SquareWave.
+  /// - The sixth section contains "WT Sine", "WT Impulse", "WT Square", "WT Saw", "WT Triangle"
   ///  and starts with WT_SineWave.
   /// *  Add the level slider to MainComponent with proper text box style
   /// and range (0.0-1.0).
@@ -61,7 +67,8 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// * Unless otherwise stated the height of all components is 24 pixels.
   /// * All subcomponents except the CPU display line are inset from
   ///   MainComponent's top, left and right by 8 pixels
-  /// * The visualizer is inset from the bottom by 24 pixels.
+  /// * The visualizer is inset from the bottom by 24 pixels. The waveform
+  ///   display takes its upper half and the spectrum display its lower half.
   /// * The width of the Audio Settings button and the Waveforms menu is 118 pixels.
   /// * There is an 8 pixel offset between the buttons and the transport button.
   /// * The width and height of the transport button is 56.
@@ -71,6 +78,10 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// * The width of the cpu usage display is 66 pixels, its Y is 24 pixels from the bottom
   ///   and it is idented from the right by 8 pixels.
   /// * The cpu label is 36 pixels width and abuts the left side of the usage display.
+  /// * The profile button is 72 pixels wide and sits at the left of the cpu
+  ///   line, followed 8 pixels later by the 140 pixel adaptive quality button.
+  /// * The profiler overlay is 360 by 174 pixels, in the top right corner of
+  ///   the visualizer.
   /// Look at Wave Lab.app image in the documentation to check your layout:
   /// http://cmp.music.illinois.edu/courses/taube/mus205/Projects/Wave%20Lab/WaveLabOutlines.png
 
@@ -80,8 +91,10 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   // Listener overrides
 
   /// MainComponent's button callback. If the button is the settingsButton the
-  /// then openAudioSettings() should be called. Otherwise the playButton was
-  /// pressed and the following action should be taken:
+  /// then openAudioSettings() should be called. If it is the profileButton the
+  /// profiler overlay is shown or hidden with the button's toggle state, and
+  /// if it is the qualityButton the engine's governor is enabled or disabled.
+  /// Otherwise the playButton was pressed and the following action should be taken:
   /// * If the mainComponent is playing then playback should stop by
   /// setting the source to nullptr and the playButton should be redrawn showing
   /// the play symbol (triangle).
@@ -91,17 +104,17 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   void buttonClicked (Button *button) override;
 
   /// MainComponent's slider callback. If slider is levelSlider the function
-  /// should update the 'level' variable with the current slider
-  /// value.  If slider is freqSlider it should update the 'freq' and
-  /// 'phaseDelta' variables.
+  /// should change the engine's level to the current slider
+  /// value.  If slider is freqSlider it should change the engine's frequency.
+  /// See changeParameter().
   void sliderValueChanged (Slider *slider) override;
 
   /// MainComponent's comboBoxChanged callback. The function should set
-  /// the waveformId member with the selected waveform id. If the id
+  /// the engine's waveform to the selected waveform id. If the id
   /// is Empty then the playButton should be disabled otherwise the
-  /// playButton should be enabled. If the id is WhiteNoise or BrownNoise
-  /// then the frequency label and slider should be disabled otherwise
-  /// they should be enabled.
+  /// playButton should be enabled. If the id is a noise other than DustNoise
+  /// then the frequency label and slider should be disabled otherwise they
+  /// should be enabled.
   void comboBoxChanged (ComboBox *menu) override;
   
   //==============================================================================
@@ -109,6 +122,8 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// The timer callback shuld get the AudioDeviceManager's cpu usage, convert
   /// it to percentage, and set the cpuUsage label to that value rounded
   /// to two digits (see String(int)) with the string " %" appended to it.
+  /// It also frees any wavetables the audio thread has stopped using and
+  /// updates the profiler overlay.
   void timerCallback() override;
   
   //==============================================================================
@@ -117,16 +132,15 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// This function will be called (on the audio thread, not the GUI
   /// thread) when the audio device is started, or when its settings
   /// (i.e. sample rate, block size, etc) are changed.
-  /// It should set the srate to the current sampling rate. set phase to 0, and
-  /// set phaseDelta to the phase increment for the current frequency
-  /// and srate. The visualizer's buffer size should be set to samplesPerBlockExpected
+  /// It should prepare the engine for the sample rate and the number of
+  /// output channels. The visualizer's buffer size should be set to samplesPerBlockExpected
   /// and it should take 8 samples per block.
   void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override ;
   
   /// Your audio-processing code goes in this function.  This function
-  /// will simply call one of the private inline waveform functions
-  /// (e.g whiteNoise(), sineWave(), etc.)  according to what
-  /// WaveFormId the user has selected.
+  /// simply has the engine render the selected waveform into the buffer's
+  /// channels and pushes the result to the visualizer. The whole block is
+  /// timed by the profiler and attributed to the waveform that played it.
   void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override ;
   
   /// This will be called when the audio device stops, or when it is
@@ -142,6 +156,10 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// is playing.
   bool isPlaying();
   
+  /// Passes the selected waveform and the engine's quality to the profiler
+  /// overlay.
+  void updateProfilerOverlay();
+
   /// Opens the application's audio settings panel.
   /// * use launchOptions to configure and launch the audio settings dialog
   /// as follows:
@@ -152,6 +170,11 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// * use launchOptions.content.setOwned() to assign the component
   /// * call launchOptions.launchAsync() to open the dialog.
   void openAudioSettings();
+
+  /// Changes an engine parameter from the message thread. While playing the
+  /// change is posted to the audio thread, which applies it with smoothing at
+  /// the right offset in its next block. Otherwise it is made at once.
+  void changeParameter (WaveEngine::Parameter parameter, double value);
   
   /// Draws the play button. Since the image will be scaled by the button use
   /// percentage coordinates (0-100) for x and y. If drawPlay is true the button
@@ -163,32 +186,14 @@ public Slider::Listener, public Button::Listener, public ComboBox::Listener, pub
   /// draw first bar at x=0  and second bar at 100-width.
   void drawPlayButton(juce::DrawableButton& b, bool drawPlay) ;
 
-  /// Called at startup to create the wavetables.
+  /// Called at startup and by prepareToPlay() to request the wavetables. They
+  /// are built on background threads and picked up by the audio thread when
+  /// they are finished.
   void createWaveTables();
 
 private:
-   StringArray noise {"White", "Brown", "Dust"};
+   StringArray noise {"White", "Brown", "Dust", "Gaussian", "Pink", "Blue", "Violet"};
    
-  /// Enumeration identifying all the different waveforms the app
-  /// generates. The Empty value indicate that no waveform has
-  /// been selected.
-  enum WaveformId {
-    Empty, WhiteNoise,  BrownNoise, DustNoise,
-    SineWave,
-    LF_ImpulseWave, LF_SquareWave, LF_SawtoothWave, LF_TriangeWave,
-    BL_ImpulseWave, BL_SquareWave, BL_SawtoothWave, BL_TriangeWave,
-    WT_SineWave,
-    WT_ImpulseWave, WT_SquareWave, WT_SawtoothWave, WT_TriangleWave,
-    WT_START = WT_SineWave
-  };
-
-  /// A variable holding the currently selected waveform to generate
-  /// (see the WaveformId enum).  Its initial value should be Empty.
-  WaveformId waveformId;
-
-  /// A Random object for generating random numbers.
-  Random random;
-
   /// A reference to the app's audio device manager.
   AudioDeviceManager& deviceManager;
 
@@ -198,8 +203,13 @@ private:
   /// must be passed to the player using player.addSource().
   AudioSourcePlayer audioSourcePlayer;
 
-  /// A specialized JUCE component that displays a wave form.
-  AudioVisualiserComponent audioVisualizer;
+  /// Displays the output's waveform. The audio thread passes it decimated
+  /// peaks without locking; the mouse wheel zooms it.
+  WaveformDisplay audioVisualizer;
+
+  /// Displays the output's spectrum and spectrogram, analyzed on a
+  /// background thread.
+  SpectrumDisplay spectrumDisplay;
   
   /// A button that opens the audio preferences window. Initialize
   /// the button to show "Audio Settings...".
@@ -244,100 +254,31 @@ private:
 //  Label cpuUsage {"0.00", "%"};
    Label cpuUsage {"0.00", "%"};
 
-  /// The current audio sample rate. Its initial value 0.0
-  /// must be updated by prepareToPlay().
-  double srate;
-
-  /// The current audio amplitude level. Its initial value 0.0
-  /// must updated by the levelSlider.
-  double level = 0.0;
-
-  /// The current audio frequency. Its initial value 0.0 must be updated
-  /// by the freqSlider.
-  double freq;
-
-  /// The current phase position of the waveform. Its initial value
-  /// 0.0 must be updated by the freqSlider.
-  double phase;
-
-  /// The phase increment per sample, e.g (freq/srate). The phase must be
-  /// reset whenever the frequency or srate changes.
-  double phaseDelta;
-
-  /// 2pi as a double value.
-  const double TwoPi {MathConstants<double>::pi * 2.0};
-
-  //==============================================================================
-  // Waveforms
-
-  /// A periodic function ranging 0.0 to 1.0. It returns the current phase
-  /// value and post-increments phase by phaseDelta. See: std::fmod().
-  double inline phasor();
-
-  /// Generates samples in a uniform random distribution.
-  void inline whiteNoise(const AudioSourceChannelInfo& bufferToFill) ;
-
-  /// Generates random uniform samples with a probability of freq/srate
-  /// across all channels.
-  void inline dust(const AudioSourceChannelInfo& bufferToFill) ;
-
-  /// Generates samples in a 'brown' distribution (-6dB per octave).
-  void inline brownNoise(const AudioSourceChannelInfo& bufferToFill) ;
-  void inline brownNoiseFilt(const AudioSourceChannelInfo& bufferToFill) ;
-
-  /// Generates a sine wave at a specified frequency and amplitude.
-  void inline sineWave(const AudioSourceChannelInfo& bufferToFill) ;
-
-  // Generators an inexpensive low frequency waves.
-  void inline LF_impulseWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline LF_squareWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline LF_sawtoothWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline LF_triangleWave(const AudioSourceChannelInfo& bufferToFill);
+  /// A toggle button that shows and hides the profiler overlay.
+  TextButton profileButton {"Profile"};
 
-  // Generators for band limited waves.
-  void inline BL_impulseWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline BL_squareWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline BL_sawtoothWave(const AudioSourceChannelInfo& bufferToFill);
-  void inline BL_triangleWave(const AudioSourceChannelInfo& bufferToFill);
-  /// Generates samples using a wavetable oscillator.
-  void inline WT_wave(const AudioSourceChannelInfo& bufferToFill);
+  /// A toggle button that lets the engine lower its quality when it comes
+  /// close to missing the audio deadline, instead of dropping out. It is on
+  /// at first.
+  ToggleButton qualityButton {"Adaptive quality"};
 
-  /// Returns a random value [-1.0, 1.0]
-  float inline ranSamp();
+  /// Times every audio block against its deadline, per waveform. The cpu
+  /// usage above is an average; the profiler keeps the worst case.
+  BlockProfiler profiler {WaveEngine::NumWaveformIds};
 
-  /// Returns a random value [-amp, amp]
-  float inline ranSamp(const float amp) ;
+  /// Shows the profiler's counters and the engine's quality over the visualizer.
+  ProfilerOverlay profilerOverlay {profiler, deviceManager};
 
-  /// The change from one filter output to the next is proportional to the
-  /// difference between the previous output and the next input.
-  /// prevout + (alpha * (value - prevout)
-  /// e.g. for i from 1 to n y[i] := y[i-1] + α * (x[i] - y[i-1])
-  float lowPass(const float value, const float prevout, const float alpha) ;
+  /// The waveform generators, rendered on the audio thread.
+  WaveEngine engine;
 
   //==============================================================================
   // Wavetable support
 
-  void createSineTable(AudioSampleBuffer& waveTable);
-  void createSquareTable(AudioSampleBuffer& waveTable);
-  void createImpulseTable(AudioSampleBuffer& waveTable);
-  void createSawtoothTable(AudioSampleBuffer& waveTable);
-  void createTriangleTable(AudioSampleBuffer& waveTable);
-  void wavetablePrepareToPlay(int wttype);
-  void wavetableSetFreq(float amp);
-  /// Wavetable for sine waves.
-  AudioSampleBuffer sineTable;
-  /// Wavetable for square waves.
-  AudioSampleBuffer squareTable;
-  /// Wavetable for impulse waves.
-  AudioSampleBuffer impulseTable;
-  /// Wavetable for sawtooth ewaves.
-  AudioSampleBuffer sawtoothTable;
-  /// Wavetable for triangle waves.
-  AudioSampleBuffer triangleTable;
-  /// Size of wavetables
-  int tableSize = 512;
-  /// Array of wavetable oscillators
-  std::vector<std::unique_ptr<WavetableOscillator>> oscillators;
+  /// Size of wavetables, a power of two. The tables are built with inverse
+  /// FFTs so a large size is cheap, and it lets level 0 hold every harmonic
+  /// of frequencies down to srate/tableSize (about 20 Hz).
+  int tableSize = 2048;
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
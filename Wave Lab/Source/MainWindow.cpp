@@ -27,12 +27,6 @@ MainWindow::MainWindow(String name)
 
 
 
-   // On windows or linux install the menubar in the window.
-   // FIXME: on iOs or Android you will do something else!
-#if JUCE_WINDOWS || JUCE_LINUX
-   setMenuBar(MainApplication::getApp().getMenuBarModel());
-#endif
-
    // add our content component. owned means that when the window is
    // deleted it will automatically delete our content component
    auto maincomp = std::make_unique<MainComponent>();
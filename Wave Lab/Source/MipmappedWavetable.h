@@ -0,0 +1,126 @@
+
+//==============================================================================
+// MipmappedWavetable.h
+// A set of band limited wavetables for one waveform, one table per octave.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// MipmappedWavetable holds one period of a waveform at several levels of
+/// band limiting. Level 0 contains as many harmonics as the table can hold
+/// (tableSize/2) and every level above it contains half the harmonics of the
+/// level below it. An oscillator stepping through the table by tableDelta
+/// samples per output sample plays harmonic h at h*tableDelta/tableSize
+/// times the sample rate, so level k is free of aliasing as long as
+/// tableDelta <= 2^k. The levels are stored one after the other in a single
+/// cache line aligned block. Each level is surrounded by guardSize samples
+/// on either side that continue the period (sample -1 repeats sample
+/// tableSize-1, sample tableSize repeats sample 0 and so on), so an
+/// interpolator can read a few samples on either side of any index in
+/// [0, tableSize) without wrapping. The block is either allocated by
+/// setSize() or is a read-only view of a memory mapped cache file (see
+/// WavetableCache).
+
+class MipmappedWavetable
+{
+public:
+  /// The number of samples before and after each level that continue the period.
+  static constexpr int guardSize = 4;
+
+  /// Returns the number of levels needed to go from tableSize/2 harmonics
+  /// down to a single harmonic.
+  static int getMaxNumLevels (int tableSize) noexcept
+  {
+    int numLevels = 1;
+    while ((tableSize >> (numLevels + 1)) >= 1)
+      ++numLevels;
+    return numLevels;
+  }
+
+  /// Returns the distance between the starts of two levels, a level and its
+  /// guard samples. It is a multiple of 4 samples when tableSize is, which
+  /// keeps every level 16 byte aligned.
+  static int getLevelStride (int tableSize) noexcept { return tableSize + 2 * guardSize; }
+
+  /// Allocates numLevels cleared tables of tableSize samples. A numLevels of
+  /// 0 allocates every level down to a single harmonic.
+  void setSize (int newTableSize, int newNumLevels = 0)
+  {
+    mappedFile.reset();
+    tableSize = newTableSize;
+    numLevels = (newNumLevels > 0) ? newNumLevels : getMaxNumLevels (tableSize);
+    storage.calloc ((size_t) getNumSamples() + alignment / sizeof (float));
+    samples = snapPointerToAlignment (storage.get(), alignment);
+  }
+
+  /// Makes the table a read-only view of numLevels levels with their guard
+  /// samples (getNumSamples() in all) starting at data, which must stay
+  /// valid as long as file is owned by the table.
+  void referToMappedFile (std::unique_ptr<MemoryMappedFile> file, const float* data,
+                          int newTableSize, int newNumLevels)
+  {
+    storage.free();
+    mappedFile = std::move (file);
+    tableSize = newTableSize;
+    numLevels = newNumLevels;
+    samples = data;
+  }
+
+  int getTableSize() const noexcept { return tableSize; }
+
+  int getNumLevels() const noexcept { return numLevels; }
+
+  /// Returns the total number of samples in all levels, including guard samples.
+  int getNumSamples() const noexcept { return numLevels * getLevelStride (tableSize); }
+
+  /// Returns the maximum number of harmonics stored in a level.
+  int getNumHarmonics (int level) const noexcept { return jmax (1, tableSize >> (level + 1)); }
+
+  /// Returns the lowest (brightest) level that plays without aliasing when
+  /// the table is read at tableDelta samples per output sample.
+  int getLevelForDelta (float tableDelta) const noexcept
+  {
+    auto level = (tableDelta > 1.0f) ? (int) std::ceil (std::log2 (tableDelta)) : 0;
+    return jmin (level, getNumLevels() - 1);
+  }
+
+  /// Returns sample 0 of a level. Indices -guardSize to tableSize+guardSize-1 are valid.
+  const float* getLevel (int level) const noexcept
+  {
+    return samples + level * getLevelStride (tableSize) + guardSize;
+  }
+
+  /// Returns the first guard sample of the first level, the start of the block.
+  const float* getData() const noexcept { return samples; }
+
+  /// Returns sample 0 of a level for writing. The table must have been
+  /// allocated by setSize(). Call updateGuardSamples() after writing.
+  float* getWritePointer (int level) noexcept
+  {
+    jassert (mappedFile == nullptr);
+    return const_cast<float*> (getLevel (level));
+  }
+
+  /// Copies the ends of a level's period into its guard samples.
+  void updateGuardSamples (int level) noexcept
+  {
+    auto* table = getWritePointer (level);
+    for (int i = 1; i <= guardSize; ++i)
+      table[-i] = table[tableSize - i];
+    for (int i = 0; i < guardSize; ++i)
+      table[tableSize + i] = table[i];
+  }
+
+  bool isMemoryMapped() const noexcept { return mappedFile != nullptr; }
+
+private:
+  /// The block is aligned to a cache line.
+  static constexpr size_t alignment = 64;
+
+  int tableSize = 0, numLevels = 0;
+  const float* samples = nullptr;
+  HeapBlock<float> storage;
+  std::unique_ptr<MemoryMappedFile> mappedFile;
+};
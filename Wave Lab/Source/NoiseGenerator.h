@@ -0,0 +1,227 @@
+
+//==============================================================================
+// NoiseGenerator.h
+// Block based white noise from a counter-based random number generator.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// NoiseGenerator fills blocks with uniform or Gaussian white noise. Instead
+/// of stepping a generator's state once per sample (like juce::Random's
+/// linear congruential generator) every sample is an integer hash of its
+/// own position in the stream, keyed by the seed and a stream number:
+///   sample[n] = hash(key(seed, stream), n)
+/// No sample depends on the one before it, so the uniform loop has no
+/// carried state and is vectorized by the compiler (SSE4.1/AVX2/NEON
+/// integer multiplies), and any block of any stream can be rendered on its
+/// own, in any order or in parallel, with identical results. A seed and a
+/// stream number (e.g. a channel) always reproduce the same noise.
+/// Gaussian noise uses Marsaglia and Tsang's ziggurat method. About 99% of
+/// the samples take the fast path of one table lookup and multiply, the
+/// rest draw additional uniforms that are hashed from the same position.
+/// The hash is a statistically good mixer, not a cryptographic generator.
+
+class NoiseGenerator
+{
+public:
+  /// The distributions of the generated samples.
+  enum Distribution
+  {
+    /// Uniform in [-1, 1).
+    Uniform,
+    /// Normal with a mean of 0 and a standard deviation of 1.
+    Gaussian
+  };
+
+  explicit NoiseGenerator (uint64 newSeed = 0)
+  {
+    setSeed (newSeed);
+    // builds the ziggurat tables now rather than on the audio thread
+    getZiggurat();
+  }
+
+  /// Sets the seed and rewinds every stream to its start.
+  void setSeed (uint64 newSeed) noexcept
+  {
+    seed = newSeed;
+    position = 0;
+  }
+
+  uint64 getSeed() const noexcept { return seed; }
+
+  void setDistribution (Distribution newDistribution) noexcept { distribution = newDistribution; }
+
+  Distribution getDistribution() const noexcept { return distribution; }
+
+  /// Returns the position of the next block, in samples from the start of the streams.
+  uint64 getPosition() const noexcept { return position; }
+
+  /// Moves every stream forward by numSamples, typically after a block has
+  /// been rendered for each channel.
+  void advance (int numSamples) noexcept { position += (uint64) numSamples; }
+
+  /// Overwrites numSamples of output with the samples of stream starting at
+  /// the current position, scaled by gain. Does not advance the position,
+  /// so rendering each channel with its own stream number and then calling
+  /// advance() gives independent channels.
+  void renderBlock (uint32 stream, float* output, int numSamples, float gain) const noexcept
+  {
+    renderStream (stream, position, output, numSamples, gain);
+  }
+
+  /// Overwrites numSamples of output with the samples of stream starting at
+  /// startPosition, scaled by gain. The result depends only on the seed, the
+  /// distribution and the arguments, so it may be called from several
+  /// threads at once.
+  void renderStream (uint32 stream, uint64 startPosition, float* output, int numSamples,
+                     float gain) const noexcept
+  {
+    while (numSamples > 0) {
+      // the counter is 32 bits, the upper half of the position selects the key
+      auto counter = (uint32) startPosition;
+      auto count = (int) jmin ((uint64) numSamples, ((uint64) 1 << 32) - counter);
+      auto key = makeKey (stream, (uint32) (startPosition >> 32));
+      if (distribution == Uniform)
+        renderUniform (key, counter, output, count, gain);
+      else
+        renderGaussian (key, counter, output, count, gain);
+      output += count;
+      numSamples -= count;
+      startPosition += (uint64) count;
+    }
+  }
+
+private:
+  struct Key { uint32 a, b; };
+
+  /// A 32 bit integer hash with full avalanche (Chris Wellons' lowbias32).
+  static forcedinline uint32 mix (uint32 x) noexcept
+  {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+  }
+
+  /// The 64 bit SplitMix finalizer, used to derive keys.
+  static uint64 mix64 (uint64 x) noexcept
+  {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  Key makeKey (uint32 stream, uint32 segment) const noexcept
+  {
+    auto k = mix64 (seed ^ mix64 (((uint64) stream << 32 | segment) + 0x9e3779b97f4a7c15ull));
+    return {(uint32) k, (uint32) (k >> 32)};
+  }
+
+  /// The random bits for a counter. Two keyed rounds, so that different
+  /// keys give unrelated sequences rather than shifted copies of one.
+  static forcedinline uint32 random (Key key, uint32 counter) noexcept
+  {
+    return mix (mix (counter ^ key.a) ^ key.b);
+  }
+
+  /// A uniform value in (0, 1) for the ziggurat's slow path. Each sample's
+  /// extra draws are numbered from 1 so they never repeat its main draw.
+  static float uniform (Key key, uint32 counter, uint32 draw) noexcept
+  {
+    auto bits = random ({key.a, key.b ^ mix (draw * 0x9e3779b9u)}, counter);
+    return ((float) (bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+  }
+
+  static void renderUniform (Key key, uint32 counter, float* output, int numSamples,
+                             float gain) noexcept
+  {
+    // the bits read as a signed integer scaled by 2^-31 fall in [-1, 1)
+    const auto scale = gain * (1.0f / 2147483648.0f);
+    for (int i = 0; i < numSamples; ++i)
+      output[i] = (float) (int32) random (key, counter + (uint32) i) * scale;
+  }
+
+  static void renderGaussian (Key key, uint32 counter, float* output, int numSamples,
+                              float gain) noexcept
+  {
+    auto& zig = getZiggurat();
+    for (int i = 0; i < numSamples; ++i) {
+      auto n = counter + (uint32) i;
+      auto hz = (int32) random (key, n);
+      auto iz = (int) (hz & 127);
+      auto value = (absolute (hz) < zig.k[iz]) ? (float) hz * zig.w[iz]
+                                               : zigguratTail (zig, key, n, hz, iz);
+      output[i] = value * gain;
+    }
+  }
+
+  static uint32 absolute (int32 x) noexcept { return (x < 0) ? 0u - (uint32) x : (uint32) x; }
+
+  /// The ziggurat tables for 128 layers, from Marsaglia and Tsang, "The
+  /// Ziggurat Method for Generating Random Variables" (2000).
+  struct Ziggurat
+  {
+    static constexpr double r = 3.442619855899;
+
+    Ziggurat()
+    {
+      const auto m = 2147483648.0;
+      const auto area = 9.91256303526217e-3;
+      auto d = r, t = r;
+      auto q = area / std::exp (-0.5 * d * d);
+      k[0] = (uint32) ((d / q) * m);
+      k[1] = 0;
+      w[0] = (float) (q / m);
+      w[127] = (float) (d / m);
+      f[0] = 1.0f;
+      f[127] = (float) std::exp (-0.5 * d * d);
+      for (int i = 126; i >= 1; --i) {
+        d = std::sqrt (-2.0 * std::log (area / d + std::exp (-0.5 * d * d)));
+        k[i + 1] = (uint32) ((d / t) * m);
+        t = d;
+        f[i] = (float) std::exp (-0.5 * d * d);
+        w[i] = (float) (d / m);
+      }
+    }
+
+    uint32 k[128];
+    float w[128], f[128];
+  };
+
+  static const Ziggurat& getZiggurat()
+  {
+    static const Ziggurat ziggurat;
+    return ziggurat;
+  }
+
+  /// The slow path of the ziggurat: the base strip's tail or the wedges
+  /// outside a layer's rectangle.
+  static float zigguratTail (const Ziggurat& zig, Key key, uint32 n, int32 hz, int iz) noexcept
+  {
+    uint32 draw = 1;
+    for (;;) {
+      auto x = (float) hz * zig.w[iz];
+      if (iz == 0) {
+        float y;
+        do {
+          x = -std::log (uniform (key, n, draw++)) * (float) (1.0 / Ziggurat::r);
+          y = -std::log (uniform (key, n, draw++));
+        } while (y + y < x * x);
+        return (hz > 0) ? (float) Ziggurat::r + x : -(float) Ziggurat::r - x;
+      }
+      if (zig.f[iz] + uniform (key, n, draw++) * (zig.f[iz - 1] - zig.f[iz]) < std::exp (-0.5f * x * x))
+        return x;
+      hz = (int32) random ({key.a, key.b ^ mix (draw++ * 0x9e3779b9u)}, n);
+      iz = (int) (hz & 127);
+      if (absolute (hz) < zig.k[iz])
+        return (float) hz * zig.w[iz];
+    }
+  }
+
+  uint64 seed = 0, position = 0;
+  Distribution distribution = Uniform;
+};
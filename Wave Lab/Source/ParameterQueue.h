@@ -0,0 +1,75 @@
+
+//==============================================================================
+// ParameterQueue.h
+// Passes timestamped parameter changes from the message thread to the audio thread.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// ParameterQueue is a single producer/single consumer lock-free queue of
+/// parameter changes. The message thread push()es a change with the time it
+/// was made and the audio thread pop()s them at the start of each block.
+/// Each change carries Time::getMillisecondCounterHiRes() at the moment of
+/// the push. Changes made during one block are played back at the same
+/// offsets in the next block (see getSampleOffset()), so a fast slider
+/// gesture keeps its timing within a block instead of landing on block
+/// boundaries. Neither side locks or allocates. If the queue is full the
+/// change is dropped and push() returns false.
+
+class ParameterQueue
+{
+public:
+  struct Change
+  {
+    int parameter = 0;
+    double value = 0.0;
+    /// Time::getMillisecondCounterHiRes() when the change was pushed.
+    double time = 0.0;
+  };
+
+  static constexpr int capacity = 256;
+
+  ParameterQueue() = default;
+
+  /// Called on the message thread.
+  bool push (int parameter, double value) noexcept
+  {
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+      return false;
+    auto index = (scope.blockSize1 > 0) ? scope.startIndex1 : scope.startIndex2;
+    changes[(size_t) index] = { parameter, value, Time::getMillisecondCounterHiRes() };
+    return true;
+  }
+
+  /// Called on the audio thread. Moves the next change to change and returns
+  /// true, or returns false if the queue is empty.
+  bool pop (Change& change) noexcept
+  {
+    const auto scope = fifo.read (1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+      return false;
+    change = changes[(size_t) ((scope.blockSize1 > 0) ? scope.startIndex1 : scope.startIndex2)];
+    return true;
+  }
+
+  /// Returns the offset in a block of numSamples at which to apply a change
+  /// made at time, given the time the previous block started. A change from
+  /// before the previous block (or any change before the first block) is
+  /// applied at the start.
+  static int getSampleOffset (double time, double previousBlockTime, double sampleRate, int numSamples) noexcept
+  {
+    if (previousBlockTime <= 0.0)
+      return 0;
+    auto offset = (time - previousBlockTime) * 0.001 * sampleRate;
+    return jlimit (0, jmax (0, numSamples - 1), (int) offset);
+  }
+
+private:
+  AbstractFifo fifo {capacity};
+  std::array<Change, capacity> changes;
+
+  JUCE_DECLARE_NON_COPYABLE (ParameterQueue)
+};
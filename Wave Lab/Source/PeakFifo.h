@@ -0,0 +1,101 @@
+
+//==============================================================================
+// PeakFifo.h
+// Passes decimated min/max peaks of the output from the audio thread to the GUI.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// PeakFifo reduces the audio thread's output to the minimum and maximum of
+/// every samplesPerPeak samples and passes them to the message thread
+/// through a single producer/single consumer lock-free queue. The audio
+/// thread does one vectorized min/max scan per channel and a few stores per
+/// block; the GUI never sees the raw samples. A bucket that is not complete
+/// at the end of a block is carried into the next. If the GUI falls behind
+/// and the queue fills, new peaks are dropped rather than blocking the audio
+/// thread.
+
+class PeakFifo
+{
+public:
+  /// The most channels the peaks are kept for.
+  static constexpr int maxChannels = 2;
+
+  struct Peak
+  {
+    float min = 0.0f, max = 0.0f;
+  };
+
+  /// The peaks of every channel over one bucket of samples.
+  struct Frame
+  {
+    std::array<Peak, maxChannels> peaks;
+  };
+
+  explicit PeakFifo (int peakSize = 8, int capacity = 16384)
+  : samplesPerPeak (peakSize), fifo (capacity), frames ((size_t) capacity)
+  {
+  }
+
+  int getSamplesPerPeak() const noexcept { return samplesPerPeak; }
+
+  /// Returns the number of channels pushed most recently.
+  int getNumChannels() const noexcept { return numChannels.load (std::memory_order_relaxed); }
+
+  /// Called on the audio thread with each block of output.
+  void push (const float* const* channels, int numChannelsToPush, int numSamples) noexcept
+  {
+    auto numPushed = jmin (numChannelsToPush, maxChannels);
+    numChannels.store (numPushed, std::memory_order_relaxed);
+    for (int start = 0; start < numSamples;) {
+      auto count = jmin (samplesPerPeak - bucketCount, numSamples - start);
+      for (int chan = 0; chan < numPushed; ++chan) {
+        float low, high;
+        FloatVectorOperations::findMinAndMax (channels[chan] + start, count, low, high);
+        auto& peak = bucket.peaks[(size_t) chan];
+        peak.min = (bucketCount == 0) ? low : jmin (peak.min, low);
+        peak.max = (bucketCount == 0) ? high : jmax (peak.max, high);
+      }
+      bucketCount += count;
+      start += count;
+      if (bucketCount == samplesPerPeak) {
+        write (bucket);
+        bucketCount = 0;
+      }
+    }
+  }
+
+  /// Called on the message thread. Passes every frame waiting in the queue
+  /// to function (const Frame&), oldest first.
+  template <typename Function>
+  void pull (Function&& function)
+  {
+    const auto scope = fifo.read (fifo.getNumReady());
+    for (int i = 0; i < scope.blockSize1; ++i)
+      function (frames[(size_t) (scope.startIndex1 + i)]);
+    for (int i = 0; i < scope.blockSize2; ++i)
+      function (frames[(size_t) (scope.startIndex2 + i)]);
+  }
+
+private:
+  void write (const Frame& frame) noexcept
+  {
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 > 0)
+      frames[(size_t) scope.startIndex1] = frame;
+    else if (scope.blockSize2 > 0)
+      frames[(size_t) scope.startIndex2] = frame;
+  }
+
+  const int samplesPerPeak;
+  AbstractFifo fifo;
+  std::vector<Frame> frames;
+  std::atomic<int> numChannels {0};
+  /// The bucket being filled on the audio thread and its number of samples.
+  Frame bucket;
+  int bucketCount = 0;
+
+  JUCE_DECLARE_NON_COPYABLE (PeakFifo)
+};
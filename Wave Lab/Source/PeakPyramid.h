@@ -0,0 +1,88 @@
+
+//==============================================================================
+// PeakPyramid.h
+// A history of min/max peaks kept at successively halved resolutions.
+//==============================================================================
+
+#pragma once
+
+#include "PeakFifo.h"
+
+/// PeakPyramid keeps the recent history of a PeakFifo's frames at several
+/// resolutions. Level 0 holds the frames as they arrive and every level
+/// above holds frames covering twice as many samples, each the min/max of
+/// two frames of the level below. Every level keeps the same number of
+/// frames, so each covers twice the time of the one below: with 4096 frames
+/// of 8 samples, level 0 covers 0.7 seconds at 48 kHz and level 11 about 25
+/// minutes. A view of any length can then be drawn from the level whose
+/// frames are just smaller than a pixel, reading at most a few frames per
+/// pixel whatever the zoom. Adding a frame costs one store per level at
+/// most, and on average two.
+
+class PeakPyramid
+{
+public:
+  using Frame = PeakFifo::Frame;
+
+  explicit PeakPyramid (int numLevelsToKeep = 12, int framesPerLevel = 4096)
+  : capacity (framesPerLevel), levels ((size_t) numLevelsToKeep)
+  {
+    for (auto& level : levels)
+      level.frames.resize ((size_t) capacity);
+  }
+
+  int getNumLevels() const noexcept { return (int) levels.size(); }
+  int getCapacity() const noexcept { return capacity; }
+
+  /// Returns the number of frames ever added to a level. Frame i of the
+  /// level is available if getNumFrames (level) - getCapacity() <= i <
+  /// getNumFrames (level).
+  int64 getNumFrames (int level) const noexcept { return levels[(size_t) level].count; }
+
+  /// Returns frame index of a level, which must be available.
+  const Frame& getFrame (int level, int64 index) const noexcept
+  {
+    return levels[(size_t) level].frames[(size_t) (index % capacity)];
+  }
+
+  /// Appends a frame to level 0 and combines it upwards.
+  void add (Frame frame) noexcept
+  {
+    for (auto& level : levels) {
+      level.frames[(size_t) (level.count++ % capacity)] = frame;
+      if (! level.hasHalf) {
+        level.half = frame;
+        level.hasHalf = true;
+        return;
+      }
+      // the second of a pair: pass their union up a level
+      for (size_t chan = 0; chan < frame.peaks.size(); ++chan) {
+        frame.peaks[chan].min = jmin (frame.peaks[chan].min, level.half.peaks[chan].min);
+        frame.peaks[chan].max = jmax (frame.peaks[chan].max, level.half.peaks[chan].max);
+      }
+      level.hasHalf = false;
+    }
+  }
+
+  /// Forgets the history.
+  void clear() noexcept
+  {
+    for (auto& level : levels) {
+      level.count = 0;
+      level.hasHalf = false;
+    }
+  }
+
+private:
+  struct Level
+  {
+    std::vector<Frame> frames;
+    int64 count = 0;
+    /// The first frame of a pair waiting for the second.
+    Frame half;
+    bool hasHalf = false;
+  };
+
+  const int capacity;
+  std::vector<Level> levels;
+};
@@ -0,0 +1,78 @@
+
+//==============================================================================
+// PhaseAccumulator.h
+// A 32 bit fixed point phase that wraps on integer overflow.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// PhaseAccumulator holds the phase of a periodic waveform as an unsigned 32
+/// bit fraction of a cycle: 0 is the start of the cycle and 2^32 would be
+/// the start of the next one. Adding the increment lets the integer overflow,
+/// which wraps the phase exactly with no fmod and no branch, and since the
+/// arithmetic is exact the phase after n samples is always n increments on,
+/// whatever the block sizes. The frequency resolution is sampleRate / 2^32
+/// (about 10 microhertz at 44.1 kHz). For a table of 2^bits samples the top
+/// bits of the phase are the table index and the bits below them the
+/// fraction between two entries.
+
+class PhaseAccumulator
+{
+public:
+  /// Sets the increment for frequency. The phase carries on from where it is.
+  void setFrequency (double frequency, double sampleRate) noexcept
+  {
+    auto cycles = (sampleRate > 0.0) ? frequency / sampleRate : 0.0;
+    // the cast keeps the increment modulo one cycle
+    increment = (uint32) (int64) std::llround ((cycles - std::floor (cycles)) * cyclesToPhase);
+  }
+
+  /// Sets the phase, in cycles (0 to 1).
+  void reset (double cycles = 0.0) noexcept
+  {
+    phase = (uint32) (int64) std::llround ((cycles - std::floor (cycles)) * cyclesToPhase);
+  }
+
+  /// Returns the current phase and advances it by one sample.
+  forcedinline uint32 advance() noexcept
+  {
+    auto current = phase;
+    phase += increment;
+    return current;
+  }
+
+  /// Advances the phase by numSamples.
+  void advance (int numSamples) noexcept { phase += increment * (uint32) numSamples; }
+
+  uint32 getPhase() const noexcept { return phase; }
+  uint32 getIncrement() const noexcept { return increment; }
+  void setPhase (uint32 newPhase) noexcept { phase = newPhase; }
+
+  /// Returns a phase in cycles (0 to 1).
+  static forcedinline float toCycles (uint32 phase) noexcept { return (float) (phase >> 8) * (1.0f / 16777216.0f); }
+
+  /// Returns the index into a table of 2^bits samples.
+  static forcedinline int getIndex (uint32 phase, int bits) noexcept { return (int) (phase >> (32 - bits)); }
+
+  /// Returns the position between two entries of a table of 2^bits samples
+  /// (0 to 1). Only the top 24 bits of the fraction are used so that it
+  /// converts to a float exactly and stays below 1.
+  static forcedinline float getFraction (uint32 phase, int bits) noexcept
+  {
+    return (float) ((phase << bits) >> 8) * (1.0f / 16777216.0f);
+  }
+
+  /// Returns log2 of a power of two table size.
+  static int getIndexBits (int tableSize) noexcept
+  {
+    jassert (isPowerOfTwo (tableSize) && tableSize > 1);
+    return findHighestSetBit ((uint32) tableSize);
+  }
+
+private:
+  static constexpr double cyclesToPhase = 4294967296.0;
+
+  uint32 phase = 0, increment = 0;
+};
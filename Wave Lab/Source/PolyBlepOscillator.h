@@ -0,0 +1,118 @@
+
+//==============================================================================
+// PolyBlepOscillator.h
+// Band limited oscillators using polynomial band limited steps and ramps.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// PolyBlepOscillator generates sawtooth, square, pulse and triangle waves by
+/// computing the inexpensive low frequency (naive) waveform and then
+/// smoothing each of its discontinuities with a two sample polynomial
+/// correction. Steps in the waveform are corrected with a PolyBLEP (band
+/// limited step) and corners, where only the slope changes, are corrected
+/// with its integral, a PolyBLAMP (band limited ramp). Every sample costs the
+/// same few operations regardless of the frequency.
+
+class PolyBlepOscillator
+{
+public:
+  /// The waveforms the oscillator can generate.
+  enum Shape { Sawtooth, Square, Pulse, Triangle };
+
+  void setShape (Shape newShape) noexcept { shape = newShape; }
+
+  /// Sets the duty cycle of the Pulse shape, the fraction of the period the
+  /// pulse is high. It is limited to stay at least a sample away from 0 and 1.
+  void setPulseWidth (double width) noexcept { pulseWidth = jlimit (0.01, 0.99, width); }
+
+  /// Sets the frequency of the oscillator. Frequencies above the Nyquist
+  /// limit are clamped to it.
+  void setFrequency (double frequency, double sampleRate) noexcept
+  {
+    phaseDelta = (sampleRate > 0.0) ? jlimit (0.0, 0.5, frequency / sampleRate) : 0.0;
+  }
+
+  void reset() noexcept { phase = 0.0; }
+
+  /// Overwrites numSamples of output with the waveform scaled by gain. Every
+  /// shape peaks at 1.0.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    auto dt = phaseDelta;
+    auto width = (shape == Square) ? 0.5 : pulseWidth;
+    // without its DC offset the pulse ranges from -2 * width to
+    // 2 - 2 * width, so its larger side is scaled to 1
+    auto pulseScale = 0.5 / jmax (width, 1.0 - width);
+    for (int i = 0; i < numSamples; ++i) {
+      auto t = phase;
+      double value = 0.0;
+      switch (shape) {
+        case Sawtooth:
+          // the naive ramp drops by 2 at the end of every period
+          value = 2.0 * t - 1.0 - polyBlep (t, dt);
+          break;
+        case Square:
+        case Pulse:
+          // steps up by 2 at the start of the period and down by 2 at
+          // width. The pulse's DC offset (2 * width - 1) is removed.
+          value = (t < width) ? 1.0 : -1.0;
+          value += polyBlep (t, dt);
+          value -= polyBlep (wrap (t - width), dt);
+          value = (value - (2.0 * width - 1.0)) * pulseScale;
+          break;
+        case Triangle:
+          // the slope changes by +/-8 per period (8 * dt per sample) at the
+          // start and the middle of the period.
+          value = 1.0 - 4.0 * std::abs (t - 0.5);
+          value += 8.0 * dt * (polyBlamp (t, dt) - polyBlamp (wrap (t - 0.5), dt));
+          break;
+      }
+      output[i] = (float) value * gain;
+      phase += dt;
+      if (phase >= 1.0)
+        phase -= 1.0;
+    }
+  }
+
+private:
+  /// Wraps a phase that is at most one period out of range back into [0, 1).
+  static double wrap (double t) noexcept { return (t < 0.0) ? t + 1.0 : t; }
+
+  /// The difference between a band limited step of height 2 and the naive
+  /// step, for a discontinuity at phase 0. It is nonzero only within one
+  /// sample (dt) on either side of the discontinuity.
+  static double polyBlep (double t, double dt) noexcept
+  {
+    if (t < dt) {
+      auto x = t / dt - 1.0;
+      return -x * x;
+    }
+    if (t > 1.0 - dt) {
+      auto x = (t - 1.0) / dt + 1.0;
+      return x * x;
+    }
+    return 0.0;
+  }
+
+  /// The difference between a band limited ramp and the naive ramp for a
+  /// slope change of one unit per sample at phase 0. This is the integral
+  /// of polyBlep() for a unit step, measured in samples.
+  static double polyBlamp (double t, double dt) noexcept
+  {
+    if (t < dt) {
+      auto x = 1.0 - t / dt;
+      return x * x * x / 6.0;
+    }
+    if (t > 1.0 - dt) {
+      auto x = (t - 1.0) / dt + 1.0;
+      return x * x * x / 6.0;
+    }
+    return 0.0;
+  }
+
+  Shape shape = Sawtooth;
+  double phase = 0.0, phaseDelta = 0.0, pulseWidth = 0.5;
+};
@@ -0,0 +1,160 @@
+//==============================================================================
+// ProfilerOverlay.cpp
+//==============================================================================
+
+#include "ProfilerOverlay.h"
+
+namespace {
+   String formatLoad(double load) {
+      return String(load * 100.0, 1) + "%";
+   }
+
+   String formatMilliseconds(double seconds) {
+      return String(seconds * 1000.0, 3) + " ms";
+   }
+}
+
+ProfilerOverlay::ProfilerOverlay (BlockProfiler& blockProfiler, AudioDeviceManager& audioDeviceManager)
+: profiler (blockProfiler), deviceManager (audioDeviceManager) {
+   addAndMakeVisible(resetButton);
+   resetButton.addListener(this);
+   addAndMakeVisible(exportButton);
+   exportButton.addListener(this);
+}
+
+void ProfilerOverlay::update (WaveEngine::WaveformId selectedWaveform, int engineQuality) {
+   if (!isVisible()) {
+      return;
+   }
+   waveform = selectedWaveform;
+   quality = engineQuality;
+   stats = profiler.getStats();
+   waveformStats = profiler.getStats(waveform);
+   deviceXRuns = deviceManager.getXRunCount();
+   repaint();
+}
+
+//==============================================================================
+// Component overrides
+//==============================================================================
+
+void ProfilerOverlay::paint (Graphics& g) {
+   g.setColour(Colours::black.withAlpha(0.75f));
+   g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.0f);
+
+   StringArray lines;
+   lines.add("Blocks: " + String(stats.numBlocks) + "   Overruns: " + String(stats.numOverruns)
+             + "   Device xruns: " + (deviceXRuns < 0 ? String("n/a") : String(deviceXRuns)));
+   lines.add("Load  p50 " + formatLoad(stats.getLoadPercentile(0.5))
+             + "  p99 " + formatLoad(stats.getLoadPercentile(0.99))
+             + "  p99.9 " + formatLoad(stats.getLoadPercentile(0.999))
+             + "  max " + formatLoad(stats.maxLoad));
+   lines.add("Worst block " + formatMilliseconds(stats.maxSeconds)
+             + ", mean " + formatMilliseconds(stats.getMeanSeconds())
+             + "   Quality: " + (quality < 0 ? String("Full (fixed)")
+                                 : String(WaveEngine::getQualityName((WaveEngine::Quality) quality))));
+   if (waveform != WaveEngine::Empty) {
+      lines.add(String(WaveEngine::getWaveformName(waveform))
+                + "  p99 " + formatLoad(waveformStats.getLoadPercentile(0.99))
+                + "  max " + formatLoad(waveformStats.maxLoad)
+                + "  overruns " + String(waveformStats.numOverruns));
+   }
+   g.setColour(Colours::white);
+   g.setFont(12.0f);
+   auto line = textArea;
+   for (auto& text : lines) {
+      g.drawText(text, line.removeFromTop(16), Justification::centredLeft, true);
+   }
+   paintHistogram(g, histogramArea.toFloat());
+}
+
+void ProfilerOverlay::resized() {
+   auto area = getLocalBounds().reduced(8);
+   auto buttons = area.removeFromBottom(22);
+   exportButton.setBounds(buttons.removeFromRight(72));
+   buttons.removeFromRight(8);
+   resetButton.setBounds(buttons.removeFromRight(56));
+   area.removeFromBottom(8);
+   textArea = area.removeFromTop(4 * 16);
+   area.removeFromTop(4);
+   histogramArea = area;
+}
+
+// One bar per bucket, its height the log of its count, so that the rare
+// slow blocks in the tail are visible next to the common ones.
+void ProfilerOverlay::paintHistogram (Graphics& g, Rectangle<float> area) const {
+   if (area.isEmpty()) {
+      return;
+   }
+   g.setColour(Colours::white.withAlpha(0.1f));
+   g.fillRect(area);
+   auto maxCount = *std::max_element(stats.counts.begin(), stats.counts.end());
+   auto barWidth = area.getWidth() / BlockProfiler::numBuckets;
+   if (maxCount > 0) {
+      auto scale = area.getHeight() / std::log1p((float) maxCount);
+      for (int bucket = 0; bucket < BlockProfiler::numBuckets; ++bucket) {
+         auto count = stats.counts[(size_t) bucket];
+         if (count == 0) {
+            continue;
+         }
+         auto height = jmax(1.0f, std::log1p((float) count) * scale);
+         g.setColour(bucket < 100 ? Colours::limegreen : Colours::orange);
+         g.fillRect(area.getX() + bucket * barWidth, area.getBottom() - height, jmax(1.0f, barWidth), height);
+      }
+   }
+   // the deadline
+   g.setColour(Colours::red);
+   g.fillRect(area.getX() + 100 * barWidth, area.getY(), 1.0f, area.getHeight());
+}
+
+//==============================================================================
+// Export
+//==============================================================================
+
+void ProfilerOverlay::buttonClicked (Button* button) {
+   if (button == &resetButton) {
+      profiler.reset();
+      update(waveform, quality);
+   }
+   else if (button == &exportButton) {
+      exportSnapshot(createSnapshot());
+   }
+}
+
+var ProfilerOverlay::createSnapshot() const {
+   auto* object = new DynamicObject();
+   object->setProperty("time", Time::getCurrentTime().toISO8601(true));
+   if (auto* device = deviceManager.getCurrentAudioDevice()) {
+      object->setProperty("device", device->getName());
+      object->setProperty("sampleRate", device->getCurrentSampleRate());
+      object->setProperty("blockSize", device->getCurrentBufferSizeSamples());
+   }
+   object->setProperty("deviceXRuns", deviceManager.getXRunCount());
+   object->setProperty("cpuUsage", deviceManager.getCpuUsage());
+   object->setProperty("quality", quality < 0 ? var() : var(WaveEngine::getQualityName((WaveEngine::Quality) quality)));
+   object->setProperty("all", profiler.getStats().toVar());
+   // only the waveforms that have played
+   auto* generators = new DynamicObject();
+   for (int id = WaveEngine::Empty + 1; id < WaveEngine::NumWaveformIds; ++id) {
+      auto generatorStats = profiler.getStats(id);
+      if (generatorStats.numBlocks > 0) {
+         generators->setProperty(WaveEngine::getWaveformName((WaveEngine::WaveformId) id), generatorStats.toVar());
+      }
+   }
+   object->setProperty("generators", var(generators));
+   return var(object);
+}
+
+void ProfilerOverlay::exportSnapshot (const var& snapshot) {
+   chooser = std::make_unique<FileChooser>("Export Profile",
+                                           File::getSpecialLocation(File::userDocumentsDirectory)
+                                              .getChildFile("Wave Lab Profile.json"),
+                                           "*.json");
+   auto flags = FileChooser::saveMode | FileChooser::canSelectFiles | FileChooser::warnAboutOverwriting;
+   chooser->launchAsync(flags, [snapshot] (const FileChooser& fileChooser) {
+      auto file = fileChooser.getResult();
+      if (file != File()) {
+         file.replaceWithText(JSON::toString(snapshot));
+      }
+   });
+}
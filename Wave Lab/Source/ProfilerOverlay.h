@@ -0,0 +1,59 @@
+//==============================================================================
+// ProfilerOverlay.h
+// A translucent panel showing the audio thread's block timings.
+//==============================================================================
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "BlockProfiler.h"
+#include "WaveEngine.h"
+
+/// ProfilerOverlay shows the counters of a BlockProfiler whose sources are
+/// WaveEngine's waveforms: the number of blocks and overruns, the device's
+/// own xrun count, the load percentiles and worst block of every block and
+/// of the selected waveform's blocks, the engine's quality, and the
+/// histogram of every block's load on a logarithmic count scale, with the
+/// deadline marked in red. It is drawn over the other displays and only
+/// updates while it is visible. Its Reset button clears the counters and its
+/// Export button saves a JSON snapshot of them, with every waveform that has
+/// played, to a file.
+
+class ProfilerOverlay : public Component, private Button::Listener
+{
+public:
+  ProfilerOverlay (BlockProfiler& profiler, AudioDeviceManager& deviceManager);
+
+  /// Reads the profiler and the device's xrun count and repaints. Call
+  /// periodically on the message thread with the selected waveform and the
+  /// quality the engine renders at, or -1 if its governor is disabled.
+  void update (WaveEngine::WaveformId selectedWaveform, int engineQuality);
+
+  void paint (Graphics& g) override;
+
+  void resized() override;
+
+private:
+  void buttonClicked (Button* button) override;
+
+  /// Returns the current counters and the device settings as a JSON object.
+  var createSnapshot() const;
+
+  /// Asks for a file and saves snapshot to it.
+  void exportSnapshot (const var& snapshot);
+
+  /// Draws the load histogram of stats into area.
+  void paintHistogram (Graphics& g, Rectangle<float> area) const;
+
+  BlockProfiler& profiler;
+  AudioDeviceManager& deviceManager;
+  BlockProfiler::Stats stats, waveformStats;
+  WaveEngine::WaveformId waveform = WaveEngine::Empty;
+  int deviceXRuns = -1, quality = -1;
+
+  TextButton resetButton {"Reset"}, exportButton {"Export..."};
+  std::unique_ptr<FileChooser> chooser;
+  Rectangle<int> textArea, histogramArea;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerOverlay)
+};
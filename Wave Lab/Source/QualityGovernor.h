@@ -0,0 +1,123 @@
+//==============================================================================
+// QualityGovernor.h
+// Steps the rendering quality down when blocks come close to their deadline.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// QualityGovernor compares the time each block took to render with the
+/// block's deadline (its duration at the sample rate) and chooses a quality
+/// level, 0 being the best and each higher level cheaper to render.
+/// * It steps down a level at once after a block that missed its deadline,
+///   or after two blocks in a row that used more than the budget, a fraction
+///   of the deadline.
+/// * It steps back up a level when no block has used more than half of the
+///   budget for the hold time, which is one second at first. The gap
+///   between the two thresholds keeps it from stepping straight back down.
+/// * If it does have to step down again within the hold time of a step up,
+///   the step up was premature and the hold time doubles, up to 32 seconds.
+///   resetHold() returns it to one second, for when the cost of rendering
+///   changes (e.g. the waveform or frequency does).
+/// While it is disabled the level is 0. The level and the settings are
+/// atomic, so other threads may read and change them while the audio
+/// thread calls update().
+
+class QualityGovernor
+{
+public:
+  explicit QualityGovernor (int numQualityLevels) noexcept
+  : numLevels (jmax (1, numQualityLevels))
+  {
+  }
+
+  /// Sets the sample rate the deadlines are computed at and returns to level
+  /// 0. Call before rendering starts.
+  void prepare (double sampleRate) noexcept
+  {
+    ticksPerSample = (sampleRate > 0.0) ? (double) Time::getHighResolutionTicksPerSecond() / sampleRate : 0.0;
+    holdSamples = (int64) (minHoldSeconds * sampleRate);
+    minHoldSamples = holdSamples;
+    maxHoldSamples = (int64) (maxHoldSeconds * sampleRate);
+    level = 0;
+    overBudget = 0;
+    sinceChange = 0;
+    peakLoad = 0.0;
+    steppedUp = false;
+  }
+
+  void setEnabled (bool shouldBeEnabled) noexcept { enabled = shouldBeEnabled; }
+  bool isEnabled() const noexcept { return enabled; }
+
+  /// Sets the fraction (0.01 to 1) of a block's deadline that rendering may use.
+  void setBudget (double fraction) noexcept { budget = jlimit (0.01, 1.0, fraction); }
+  double getBudget() const noexcept { return budget; }
+
+  /// Returns the current level.
+  int getLevel() const noexcept { return level.load (std::memory_order_relaxed); }
+
+  /// Shortens the hold time back to its minimum.
+  void resetHold() noexcept { holdSamples = minHoldSamples; }
+
+  /// Called on the audio thread after each block of numSamples that took
+  /// ticks (see Time::getHighResolutionTicks()) to render. Returns the level
+  /// to render the next block at.
+  int update (int64 ticks, int numSamples) noexcept
+  {
+    if (! enabled.load (std::memory_order_relaxed) || ticksPerSample <= 0.0 || numSamples <= 0) {
+      setLevel (0);
+      return 0;
+    }
+    auto load = (double) ticks / (ticksPerSample * numSamples);
+    auto limit = budget.load (std::memory_order_relaxed);
+    auto current = getLevel();
+    sinceChange += numSamples;
+    overBudget = (load > limit) ? overBudget + 1 : 0;
+    if ((load > 1.0 || overBudget >= 2) && current < numLevels - 1) {
+      if (steppedUp && sinceChange < holdSamples)
+        holdSamples = jmin (holdSamples * 2, maxHoldSamples);
+      setLevel (current + 1);
+      steppedUp = false;
+      return current + 1;
+    }
+    peakLoad = jmax (peakLoad, load);
+    if (current > 0 && sinceChange >= holdSamples) {
+      if (peakLoad < 0.5 * limit) {
+        setLevel (current - 1);
+        steppedUp = true;
+        return current - 1;
+      }
+      // not yet, start a new hold
+      sinceChange = 0;
+      peakLoad = 0.0;
+    }
+    return current;
+  }
+
+private:
+  void setLevel (int newLevel) noexcept
+  {
+    if (newLevel != getLevel()) {
+      level.store (newLevel, std::memory_order_relaxed);
+      overBudget = 0;
+      sinceChange = 0;
+      peakLoad = 0.0;
+    }
+  }
+
+  static constexpr double minHoldSeconds = 1.0, maxHoldSeconds = 32.0;
+
+  const int numLevels;
+  std::atomic<bool> enabled {false};
+  std::atomic<double> budget {0.7};
+  std::atomic<int> level {0};
+
+  /// The audio thread's state.
+  double ticksPerSample = 0.0, peakLoad = 0.0;
+  int64 holdSamples = 0, minHoldSamples = 0, maxHoldSamples = 0, sinceChange = 0;
+  int overBudget = 0;
+  bool steppedUp = false;
+
+  JUCE_DECLARE_NON_COPYABLE (QualityGovernor)
+};
@@ -0,0 +1,55 @@
+
+//==============================================================================
+// SampleFifo.h
+// Passes a stream of samples from the audio thread to a background thread.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// SampleFifo is a single producer/single consumer lock-free queue of
+/// samples. The audio thread push()es each block with at most two copies
+/// and the consumer read()s whatever has arrived. Neither side locks or
+/// allocates. If the consumer falls behind, samples that do not fit are
+/// dropped rather than blocking the audio thread.
+
+class SampleFifo
+{
+public:
+  explicit SampleFifo (int capacity)
+  : fifo (capacity), buffer ((size_t) capacity)
+  {
+  }
+
+  /// Called on the audio thread. Returns the number of samples queued.
+  int push (const float* samples, int numSamples) noexcept
+  {
+    const auto scope = fifo.write (numSamples);
+    if (scope.blockSize1 > 0)
+      FloatVectorOperations::copy (buffer.data() + scope.startIndex1, samples, scope.blockSize1);
+    if (scope.blockSize2 > 0)
+      FloatVectorOperations::copy (buffer.data() + scope.startIndex2, samples + scope.blockSize1, scope.blockSize2);
+    return scope.blockSize1 + scope.blockSize2;
+  }
+
+  /// Called on the consumer thread. Moves up to numSamples queued samples
+  /// to destination and returns the number moved.
+  int read (float* destination, int numSamples) noexcept
+  {
+    const auto scope = fifo.read (numSamples);
+    if (scope.blockSize1 > 0)
+      FloatVectorOperations::copy (destination, buffer.data() + scope.startIndex1, scope.blockSize1);
+    if (scope.blockSize2 > 0)
+      FloatVectorOperations::copy (destination + scope.blockSize1, buffer.data() + scope.startIndex2, scope.blockSize2);
+    return scope.blockSize1 + scope.blockSize2;
+  }
+
+  int getNumReady() const noexcept { return fifo.getNumReady(); }
+
+private:
+  AbstractFifo fifo;
+  std::vector<float> buffer;
+
+  JUCE_DECLARE_NON_COPYABLE (SampleFifo)
+};
@@ -0,0 +1,128 @@
+
+//==============================================================================
+// SineOscillator.h
+// A sine and cosine oscillator that rotates a complex phasor.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// SineOscillator generates a sine wave, and optionally its cosine, without
+/// calling std::sin for every sample. The oscillator's state is a unit complex number (cos,
+/// sin) that is multiplied every sample by the rotation (cos w, sin w) for
+/// the phase increment w, which costs four multiplies and two adds. To run
+/// several samples at once each lane of a SIMD register holds the phasor
+/// one sample further on, and all lanes rotate by numLanes * w per step.
+/// Rounding slowly changes the phasor's length, so it is scaled back to
+/// 1 every few steps with one Newton step for 1/sqrt(length^2). The
+/// rounded rotation also has a slightly wrong angle, so the phase is kept
+/// in double precision too and the phasor is set from it after every block,
+/// which keeps the error from growing beyond a block's worth of rotations.
+
+class SineOscillator
+{
+public:
+  SineOscillator() { reset(); }
+
+  /// Sets the frequency. The phase carries on from where it is.
+  void setFrequency (double frequency, double sampleRate) noexcept
+  {
+    auto increment = (sampleRate > 0.0) ? MathConstants<double>::twoPi * frequency / sampleRate : 0.0;
+    if (increment == phaseIncrement)
+      return;
+    phaseIncrement = increment;
+    stepCos = (float) std::cos (increment);
+    stepSin = (float) std::sin (increment);
+    alignas (SIMDFloat::SIMDRegisterSize) float cosines[numLanes], sines[numLanes];
+    for (int lane = 0; lane < numLanes; ++lane) {
+      cosines[lane] = (float) std::cos (increment * lane);
+      sines[lane] = (float) std::sin (increment * lane);
+    }
+    laneCos = SIMDFloat::fromRawArray (cosines);
+    laneSin = SIMDFloat::fromRawArray (sines);
+    registerCos = (float) std::cos (increment * numLanes);
+    registerSin = (float) std::sin (increment * numLanes);
+  }
+
+  /// Sets the phase, in cycles (0 to 1).
+  void reset (double newPhase = 0.0) noexcept
+  {
+    phase = MathConstants<double>::twoPi * newPhase;
+    setPhasor();
+  }
+
+  /// Overwrites numSamples of sine with the sine wave scaled by gain and,
+  /// if cosine is not nullptr, numSamples of cosine with the cosine wave.
+  void renderBlock (float* sine, float* cosine, int numSamples, float gain) noexcept
+  {
+    auto numVector = numSamples / numLanes * numLanes;
+    renderVector (sine, cosine, numVector, gain);
+    for (int i = numVector; i < numSamples; ++i) {
+      sine[i] = imag * gain;
+      if (cosine != nullptr)
+        cosine[i] = real * gain;
+      rotate (stepCos, stepSin);
+    }
+    phase = std::fmod (phase + phaseIncrement * numSamples, MathConstants<double>::twoPi);
+    setPhasor();
+  }
+
+private:
+  using SIMDFloat = dsp::SIMDRegister<float>;
+  static constexpr int numLanes = (int) SIMDFloat::SIMDNumElements;
+  /// The number of register steps between renormalizations.
+  static constexpr int normalizeInterval = 64;
+
+  /// Renders numSamples, a multiple of numLanes. Stores go through an
+  /// aligned buffer since sine and cosine may not be aligned alike.
+  void renderVector (float* sine, float* cosine, int numSamples, float gain) noexcept
+  {
+    if (numSamples <= 0)
+      return;
+    alignas (SIMDFloat::SIMDRegisterSize) float lanes[numLanes];
+    // lane k starts k samples after the current phasor
+    auto re = laneCos * real - laneSin * imag;
+    auto im = laneCos * imag + laneSin * real;
+    for (int i = 0, step = 0; i < numSamples; i += numLanes) {
+      (im * gain).copyToRawArray (lanes);
+      std::memcpy (sine + i, lanes, sizeof (lanes));
+      if (cosine != nullptr) {
+        (re * gain).copyToRawArray (lanes);
+        std::memcpy (cosine + i, lanes, sizeof (lanes));
+      }
+      auto nextRe = re * registerCos - im * registerSin;
+      im = re * registerSin + im * registerCos;
+      re = nextRe;
+      if (++step == normalizeInterval) {
+        auto scale = (re * re + im * im) * -0.5f + 1.5f;
+        re *= scale;
+        im *= scale;
+        step = 0;
+      }
+    }
+    real = re.get (0);
+    imag = im.get (0);
+  }
+
+  forcedinline void rotate (float c, float s) noexcept
+  {
+    auto nextReal = real * c - imag * s;
+    imag = real * s + imag * c;
+    real = nextReal;
+  }
+
+  void setPhasor() noexcept
+  {
+    real = (float) std::cos (phase);
+    imag = (float) std::sin (phase);
+  }
+
+  /// The phasor of the next sample and its exact phase in radians.
+  float real = 1.0f, imag = 0.0f;
+  double phase = 0.0, phaseIncrement = 0.0;
+  /// The rotation by one sample and by numLanes samples.
+  float stepCos = 1.0f, stepSin = 0.0f, registerCos = 1.0f, registerSin = 0.0f;
+  /// Lane k holds the rotation by k samples.
+  SIMDFloat laneCos = SIMDFloat::expand (1.0f), laneSin = SIMDFloat::expand (0.0f);
+};
@@ -0,0 +1,90 @@
+
+//==============================================================================
+// SmoothedParameter.h
+// A parameter that glides to new values instead of jumping.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// SmoothedParameter moves its current value towards a target over a set
+/// time so a change does not produce a click or zipper noise.
+/// * Linear reaches the target in a straight line after exactly the
+///   smoothing time. It suits gains, which must be able to reach 0.
+/// * Exponential approaches the target like a one pole lowpass with the
+///   smoothing time as its time constant, fast at first and then slower,
+///   and snaps to the target once it is within a millionth of it. It suits
+///   frequencies, whose changes are heard in proportion to their size.
+/// * None jumps to the target.
+/// The value is advanced a run of samples at a time by advance(), which
+/// lets a caller render the run with the values at its two ends.
+
+class SmoothedParameter
+{
+public:
+  enum Smoothing { None, Linear, Exponential };
+
+  SmoothedParameter (Smoothing smoothingType, double smoothingSeconds) noexcept
+  : smoothing (smoothingType), seconds (smoothingSeconds)
+  {
+  }
+
+  /// Sets the sample rate and jumps to the target.
+  void prepare (double sampleRate) noexcept
+  {
+    smoothingSamples = jmax (1.0, seconds * sampleRate);
+    snap (target);
+  }
+
+  /// Sets a new target to move to from the current value.
+  void setTarget (double newTarget) noexcept
+  {
+    target = newTarget;
+    if (smoothing == None || current == target) {
+      snap (target);
+      return;
+    }
+    remaining = (int) smoothingSamples;
+    step = (target - current) / smoothingSamples;
+  }
+
+  /// Sets the current value and the target without smoothing.
+  void snap (double value) noexcept
+  {
+    current = target = value;
+    remaining = 0;
+  }
+
+  double getCurrent() const noexcept { return current; }
+  double getTarget() const noexcept { return target; }
+  bool isSmoothing() const noexcept { return current != target; }
+
+  /// Moves the current value numSamples towards the target and returns it.
+  double advance (int numSamples) noexcept
+  {
+    if (! isSmoothing())
+      return current;
+    if (smoothing == Linear) {
+      if (numSamples >= remaining)
+        snap (target);
+      else {
+        current += step * numSamples;
+        remaining -= numSamples;
+      }
+    }
+    else {
+      current = target + (current - target) * std::exp (-numSamples / smoothingSamples);
+      if (std::abs (current - target) <= 1.0e-6 * jmax (1.0, std::abs (target)))
+        snap (target);
+    }
+    return current;
+  }
+
+private:
+  Smoothing smoothing;
+  double seconds, smoothingSamples = 1.0;
+  double current = 0.0, target = 0.0, step = 0.0;
+  /// The samples left in a linear ramp.
+  int remaining = 0;
+};
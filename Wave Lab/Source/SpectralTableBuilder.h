@@ -0,0 +1,84 @@
+
+//==============================================================================
+// SpectralTableBuilder.h
+// Builds wavetables from harmonic spectra with a single inverse FFT.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// The amplitudes and phases of harmonics 1 to getNumHarmonics() of a
+/// periodic waveform. Harmonic k contributes amplitude * sin(k*x + phase).
+struct HarmonicSpectrum
+{
+  explicit HarmonicSpectrum (int numHarmonics)
+  : amplitudes ((size_t) numHarmonics + 1, 0.0f), phases ((size_t) numHarmonics + 1, 0.0f) {}
+
+  int getNumHarmonics() const noexcept { return (int) amplitudes.size() - 1; }
+
+  void setHarmonic (int harmonic, float amplitude, float phase = 0.0f)
+  {
+    amplitudes[(size_t) harmonic] = amplitude;
+    phases[(size_t) harmonic] = phase;
+  }
+
+  /// Indexed by harmonic number, index 0 (DC) is unused.
+  std::vector<float> amplitudes, phases;
+};
+
+/// SpectralTableBuilder turns a HarmonicSpectrum into one period of a
+/// waveform with an inverse FFT, which costs O(N log N) for a table of N
+/// samples instead of the O(N * harmonics) of summing sines in the time
+/// domain. Band limiting to any number of harmonics is done by leaving the
+/// bins above it empty. The table size must be a power of two. A builder
+/// keeps its own scratch buffer, so use one builder per thread.
+class SpectralTableBuilder
+{
+public:
+  explicit SpectralTableBuilder (int tableSize)
+  : size (tableSize),
+  fft (findHighestSetBit ((uint32) tableSize)),
+  bins ((size_t) tableSize * 2)
+  {
+    jassert (isPowerOfTwo (tableSize));
+  }
+
+  int getTableSize() const noexcept { return size; }
+
+  /// Writes tableSize samples of the waveform made from the spectrum's first
+  /// maxHarmonic harmonics (at most tableSize/2), scaled by gain, followed
+  /// by a copy of the first sample.
+  void render (const HarmonicSpectrum& spectrum, int maxHarmonic, float gain, float* table)
+  {
+    maxHarmonic = jmin (maxHarmonic, spectrum.getNumHarmonics(), size / 2);
+    std::fill (bins.begin(), bins.end(), 0.0f);
+    // The inverse transform is scaled by 1/size, so a sine of amplitude a
+    // and phase p has the bin value (size * a / 2) * (sin p - i cos p), and
+    // the mirrored bin holds its complex conjugate.
+    for (auto k = 1; k <= maxHarmonic; ++k) {
+      auto magnitude = 0.5f * (float) size * gain * spectrum.amplitudes[(size_t) k];
+      auto phase = spectrum.phases[(size_t) k];
+      auto re = magnitude * std::sin (phase);
+      auto im = -magnitude * std::cos (phase);
+      if (k == size / 2) {
+        // the Nyquist bin is real and is not mirrored
+        bins[(size_t) (2 * k)] = 2.0f * re;
+        continue;
+      }
+      bins[(size_t) (2 * k)] = re;
+      bins[(size_t) (2 * k + 1)] = im;
+      bins[(size_t) (2 * (size - k))] = re;
+      bins[(size_t) (2 * (size - k) + 1)] = -im;
+    }
+    fft.performRealOnlyInverseTransform (bins.data());
+    std::copy (bins.begin(), bins.begin() + size, table);
+    table[size] = table[0];
+  }
+
+private:
+  const int size;
+  dsp::FFT fft;
+  /// Interleaved complex bins, also the in-place output of the transform.
+  std::vector<float> bins;
+};
@@ -0,0 +1,59 @@
+//==============================================================================
+// SpectrumAnalyzer.cpp
+//==============================================================================
+
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+: Thread ("Spectrum Analyzer"),
+  history ((size_t) fftSize), window ((size_t) fftSize), fftData ((size_t) fftSize * 2),
+  average ((size_t) numBins), columns ((size_t) columnCapacity) {
+   // a periodic Hann window; its coherent gain is 1/2 so a sine of
+   // amplitude 1 peaks at fftSize / 4
+   for (int i = 0; i < fftSize; ++i) {
+      window[(size_t) i] = 0.5f - 0.5f * std::cos(MathConstants<float>::twoPi * i / fftSize);
+   }
+   magnitudeScale = 4.0f / fftSize;
+   startThread(3);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+   stopThread(1000);
+}
+
+void SpectrumAnalyzer::run() {
+   // the audio thread never signals, so the thread polls at about the rate
+   // the hops arrive
+   while (! threadShouldExit()) {
+      auto* hop = history.data() + fftSize - hopSize;
+      hopFill += samples.read(hop + hopFill, hopSize - hopFill);
+      if (hopFill < hopSize) {
+         wait(10);
+         continue;
+      }
+      analyze();
+      std::copy(history.begin() + hopSize, history.end(), history.begin());
+      hopFill = 0;
+   }
+}
+
+void SpectrumAnalyzer::analyze() noexcept {
+   FloatVectorOperations::multiply(fftData.data(), history.data(), window.data(), fftSize);
+   FloatVectorOperations::clear(fftData.data() + fftSize, fftSize);
+   fft.performFrequencyOnlyForwardTransform(fftData.data());
+   FloatVectorOperations::multiply(fftData.data(), magnitudeScale, numBins);
+
+   auto weight = averaging.load();
+   FloatVectorOperations::multiply(average.data(), 1.0f - weight, numBins);
+   FloatVectorOperations::addWithMultiply(average.data(), fftData.data(), weight, numBins);
+
+   const auto scope = columnFifo.write(1);
+   if (scope.blockSize1 + scope.blockSize2 == 0) {
+      return;
+   }
+   auto& column = columns[(size_t) ((scope.blockSize1 > 0) ? scope.startIndex1 : scope.startIndex2)];
+   for (int bin = 0; bin < numBins; ++bin) {
+      column.levels[(size_t) bin] = Decibels::gainToDecibels(fftData[(size_t) bin], minDecibels);
+      column.averages[(size_t) bin] = Decibels::gainToDecibels(average[(size_t) bin], minDecibels);
+   }
+}
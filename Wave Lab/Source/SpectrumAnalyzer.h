@@ -0,0 +1,101 @@
+//==============================================================================
+// SpectrumAnalyzer.h
+// Analyzes the audio output's spectrum on a background thread.
+//==============================================================================
+
+#pragma once
+
+#include "SampleFifo.h"
+
+/// SpectrumAnalyzer measures the spectrum of the audio output without
+/// adding more than a copy to the audio callback. pushSamples() queues the
+/// first channel in a SampleFifo. A background thread reads it, and every
+/// hopSize samples it multiplies the latest fftSize samples by a Hann window
+/// (a vectorized multiply), runs a dsp::FFT on them and converts the
+/// magnitudes to decibels, scaled so a full scale sine reads 0 dB. Each
+/// analysis becomes a Column holding that frame's levels, for a
+/// spectrogram, and a running exponential average of the frames, for a
+/// steadier spectrum line. Columns are passed to the message thread
+/// through a second lock-free queue and read with pullColumns(). If nobody
+/// reads them the newest columns are dropped.
+
+class SpectrumAnalyzer : private Thread
+{
+public:
+  static constexpr int fftOrder = 12;
+  static constexpr int fftSize = 1 << fftOrder;
+  static constexpr int numBins = fftSize / 2;
+  /// The samples between analyses, an overlap of 75%.
+  static constexpr int hopSize = fftSize / 4;
+  /// The level reported for silence.
+  static constexpr float minDecibels = -120.0f;
+
+  /// One analysis, in decibels per bin.
+  struct Column
+  {
+    std::array<float, numBins> levels;
+    std::array<float, numBins> averages;
+  };
+
+  /// Starts the analysis thread.
+  SpectrumAnalyzer();
+
+  /// Stops the analysis thread.
+  ~SpectrumAnalyzer() override;
+
+  /// Called on the audio thread with each block of output. Only the first
+  /// channel is analyzed. Wait-free.
+  void pushSamples (const float* const* channels, int numChannels, int numSamples) noexcept
+  {
+    if (numChannels > 0)
+      samples.push (channels[0], numSamples);
+  }
+
+  /// Sets the sample rate of the pushed samples, used to label the bins.
+  void setSampleRate (double newSampleRate) noexcept { sampleRate.store (newSampleRate); }
+  double getSampleRate() const noexcept { return sampleRate.load(); }
+
+  /// Returns the centre frequency of a bin in hertz.
+  double getBinFrequency (float bin) const noexcept { return bin * getSampleRate() / fftSize; }
+
+  /// Sets the weight of each new frame in the average, between 0 (the
+  /// average never changes) and 1 (no averaging).
+  void setAveraging (float weight) noexcept { averaging.store (jlimit (0.0f, 1.0f, weight)); }
+
+  /// Called on the message thread. Passes every column analyzed since the
+  /// last call to function (const Column&), oldest first.
+  template <typename Function>
+  void pullColumns (Function&& function)
+  {
+    const auto scope = columnFifo.read (columnFifo.getNumReady());
+    for (int i = 0; i < scope.blockSize1; ++i)
+      function (columns[(size_t) (scope.startIndex1 + i)]);
+    for (int i = 0; i < scope.blockSize2; ++i)
+      function (columns[(size_t) (scope.startIndex2 + i)]);
+  }
+
+private:
+  void run() override;
+
+  /// Analyzes the samples in history and queues the column.
+  void analyze() noexcept;
+
+  static constexpr int columnCapacity = 32;
+
+  SampleFifo samples {1 << 16};
+  std::atomic<double> sampleRate {44100.0};
+  std::atomic<float> averaging {0.25f};
+
+  /// Owned by the analysis thread: the latest fftSize samples, the samples
+  /// of the next hop read so far, the window and the FFT buffer.
+  dsp::FFT fft {fftOrder};
+  std::vector<float> history, window, fftData, average;
+  int hopFill = 0;
+  /// Scales the FFT magnitudes so a full scale sine peaks at 1.
+  float magnitudeScale = 1.0f;
+
+  AbstractFifo columnFifo {columnCapacity};
+  std::vector<Column> columns;
+
+  JUCE_DECLARE_NON_COPYABLE (SpectrumAnalyzer)
+};
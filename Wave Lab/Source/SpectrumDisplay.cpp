@@ -0,0 +1,127 @@
+//==============================================================================
+// SpectrumDisplay.cpp
+//==============================================================================
+
+#include "SpectrumDisplay.h"
+
+SpectrumDisplay::SpectrumDisplay() {
+   setOpaque(true);
+   spectrum.fill(SpectrumAnalyzer::minDecibels);
+   // black through blue and red to yellow as the level rises
+   for (size_t i = 0; i < palette.size(); ++i) {
+      auto level = (float) i / (palette.size() - 1);
+      palette[i] = Colour::fromHSV(0.7f - 0.55f * level, 1.0f, jmin(1.0f, 2.0f * level), 1.0f);
+   }
+   startTimerHz(30);
+}
+
+SpectrumDisplay::~SpectrumDisplay() {
+   stopTimer();
+}
+
+//==============================================================================
+// Component overrides
+//==============================================================================
+
+void SpectrumDisplay::paint(Graphics& g) {
+   g.fillAll(Colours::black);
+   if (spectrogram.isValid()) {
+      g.drawImageAt(spectrogram, spectrogramArea.getX(), spectrogramArea.getY());
+   }
+   if (spectrumArea.isEmpty() || columnBins.empty()) {
+      return;
+   }
+   auto top = (float) spectrumArea.getY();
+   auto bottom = (float) spectrumArea.getBottom();
+   Path path;
+   for (int x = 0; x < spectrumArea.getWidth(); ++x) {
+      auto level = getPeak(spectrum.data(), columnBins[(size_t) x], columnBins[(size_t) x + 1]);
+      auto y = jmap(jmax(level, floorDecibels), floorDecibels, 0.0f, bottom, top);
+      if (x == 0) {
+         path.startNewSubPath((float) spectrumArea.getX(), y);
+      }
+      else {
+         path.lineTo((float) (spectrumArea.getX() + x), y);
+      }
+   }
+   g.setColour(Colours::white);
+   g.strokePath(path, PathStrokeType(1.0f));
+}
+
+void SpectrumDisplay::resized() {
+   auto area = getLocalBounds();
+   spectrumArea = area.removeFromTop(area.getHeight() / 3);
+   spectrogramArea = area;
+   // the history is lost when the size changes
+   spectrogram = spectrogramArea.isEmpty() ? Image()
+      : Image(Image::RGB, spectrogramArea.getWidth(), spectrogramArea.getHeight(), true);
+   updateBinRanges();
+}
+
+//==============================================================================
+// Timer overrides
+//==============================================================================
+
+void SpectrumDisplay::timerCallback() {
+   if (analyzer.getSampleRate() != binSampleRate) {
+      updateBinRanges();
+   }
+   bool pulled = false;
+   analyzer.pullColumns([this, &pulled] (const SpectrumAnalyzer::Column& column) {
+      drawColumn(column);
+      spectrum = column.averages;
+      pulled = true;
+   });
+   if (pulled) {
+      repaint();
+   }
+}
+
+//==============================================================================
+// Drawing
+//==============================================================================
+
+void SpectrumDisplay::updateBinRanges() {
+   binSampleRate = analyzer.getSampleRate();
+   auto width = spectrumArea.getWidth();
+   columnBins.resize((size_t) width + 1);
+   for (int x = 0; x <= width; ++x) {
+      columnBins[(size_t) x] = (int) getBinAt((double) x / jmax(1, width));
+   }
+   auto height = spectrogramArea.getHeight();
+   rowBins.resize((size_t) height + 1);
+   for (int y = 0; y <= height; ++y) {
+      rowBins[(size_t) y] = (int) getBinAt((double) y / jmax(1, height));
+   }
+}
+
+void SpectrumDisplay::drawColumn(const SpectrumAnalyzer::Column& column) {
+   if (! spectrogram.isValid()) {
+      return;
+   }
+   auto width = spectrogram.getWidth();
+   auto height = spectrogram.getHeight();
+   spectrogram.moveImageSection(0, 0, 1, 0, width - 1, height);
+   Image::BitmapData pixels (spectrogram, width - 1, 0, 1, height, Image::BitmapData::writeOnly);
+   for (int row = 0; row < height; ++row) {
+      auto level = getPeak(column.levels.data(), rowBins[(size_t) row], rowBins[(size_t) row + 1]);
+      pixels.setPixelColour(0, height - 1 - row, getLevelColour(level));
+   }
+}
+
+float SpectrumDisplay::getBinAt(double proportion) const {
+   auto nyquist = binSampleRate * 0.5;
+   auto frequency = minFrequency * std::pow(nyquist / minFrequency, proportion);
+   return (float) (frequency * SpectrumAnalyzer::fftSize / binSampleRate);
+}
+
+float SpectrumDisplay::getPeak(const float* levels, int first, int last) noexcept {
+   first = jlimit(0, SpectrumAnalyzer::numBins - 1, first);
+   last = jlimit(first + 1, SpectrumAnalyzer::numBins, last);
+   return FloatVectorOperations::findMaximum(levels + first, last - first);
+}
+
+Colour SpectrumDisplay::getLevelColour(float decibels) const noexcept {
+   auto level = jlimit(0.0f, 1.0f, (decibels - floorDecibels) / -floorDecibels);
+   return palette[(size_t) (level * (palette.size() - 1))];
+}
@@ -0,0 +1,75 @@
+//==============================================================================
+// SpectrumDisplay.h
+// A spectrum line and scrolling spectrogram of the output.
+//==============================================================================
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SpectrumAnalyzer.h"
+
+/// SpectrumDisplay shows the output of a SpectrumAnalyzer: the averaged
+/// spectrum as a line across the top, and below it a spectrogram that
+/// scrolls left one pixel per analysis, with frequency rising upwards and
+/// level shown by colour. Both use a logarithmic frequency axis from
+/// minFrequency to the Nyquist frequency, and a pixel that spans several
+/// bins shows the loudest of them so that narrow partials (and alias
+/// products) stay visible. The spectrogram is kept in an Image and only
+/// the newest column is drawn for each analysis.
+
+class SpectrumDisplay : public Component, private Timer
+{
+public:
+  SpectrumDisplay();
+
+  ~SpectrumDisplay() override;
+
+  /// Called on the audio thread with each block of output. Wait-free.
+  void pushSamples (const float* const* channels, int numChannels, int numSamples) noexcept
+  {
+    analyzer.pushSamples (channels, numChannels, numSamples);
+  }
+
+  /// Sets the sample rate of the pushed samples.
+  void setSampleRate (double sampleRate) noexcept { analyzer.setSampleRate (sampleRate); }
+
+  void paint (Graphics& g) override;
+
+  void resized() override;
+
+private:
+  void timerCallback() override;
+
+  /// Maps the pixels of both views to ranges of bins.
+  void updateBinRanges();
+
+  /// Scrolls the spectrogram left and draws column at its right edge.
+  void drawColumn (const SpectrumAnalyzer::Column& column);
+
+  /// Returns the bin at proportion (0 to 1) of the frequency axis.
+  float getBinAt (double proportion) const;
+
+  /// Returns the loudest of levels over bins first to last.
+  static float getPeak (const float* levels, int first, int last) noexcept;
+
+  /// Returns the colour of a level in decibels.
+  Colour getLevelColour (float decibels) const noexcept;
+
+  static constexpr double minFrequency = 20.0;
+  static constexpr float floorDecibels = -100.0f;
+
+  SpectrumAnalyzer analyzer;
+
+  Rectangle<int> spectrumArea, spectrogramArea;
+  Image spectrogram;
+  std::array<float, SpectrumAnalyzer::numBins> spectrum;
+
+  /// The first bin of each spectrum column and spectrogram row (from the
+  /// bottom), plus the end of the last, and the sample rate they were made for.
+  std::vector<int> columnBins, rowBins;
+  double binSampleRate = 0.0;
+
+  std::array<Colour, 256> palette;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumDisplay)
+};
@@ -0,0 +1,633 @@
+//==============================================================================
+// WaveEngine.cpp
+//==============================================================================
+
+#include "WaveEngine.h"
+
+WaveEngine::WaveEngine() {
+   // builds the sinc kernel now rather than on the audio thread
+   WindowedSincKernel::get();
+   for (auto& voice : voices) {
+      for (auto& oscillator : voice.oscillators) {
+         oscillator.setInterpolation(interpolation);
+      }
+   }
+}
+
+void WaveEngine::prepare (double newSampleRate, int numChannels, int64 seed) {
+   sampleRate = newSampleRate;
+   levelSmoother.prepare(sampleRate);
+   frequencySmoother.prepare(sampleRate);
+   previousBlockTime = 0.0;
+   crossfadeSamples = jmax(1, (int) (crossfadeSeconds * sampleRate));
+   fadeRemaining = 0;
+   pendingWaveform = NumWaveformIds;
+   governor.prepare(sampleRate);
+   random.setSeed(seed);
+   for (auto& voice : voices) {
+      voice.prepare(sampleRate, numChannels, random);
+      for (auto& generator : voice.dustGenerators) {
+         generator.setBandLimited(dustBandLimited);
+      }
+      voice.quality = FullQuality;
+      voice.kernel = getKernel(voice.waveform, interpolation, voice.quality);
+      voice.setFrequency(frequencySmoother.getCurrent());
+      voice.level = levelSmoother.getCurrent();
+   }
+}
+
+// The tables are independent of the sample rate (the oscillators choose their
+// band limited level from it), so they are only rebuilt if tableSize changes.
+void WaveEngine::requestWavetables (int tableSize) {
+   wavetableBuilder.requestBuild(tableSize);
+}
+
+void WaveEngine::collectGarbage() {
+   wavetableBuilder.collectGarbage();
+}
+
+const char* WaveEngine::getWaveformName (WaveformId id) noexcept {
+   static const char* const names[NumWaveformIds] = {
+      "Empty", "WhiteNoise", "BrownNoise", "DustNoise", "GaussianNoise", "PinkNoise", "BlueNoise", "VioletNoise",
+      "SineWave",
+      "LF_ImpulseWave", "LF_SquareWave", "LF_SawtoothWave", "LF_TriangeWave",
+      "BL_ImpulseWave", "BL_SquareWave", "BL_SawtoothWave", "BL_TriangeWave",
+      "BLF_SquareWave", "BLF_SawtoothWave", "BLF_PulseWave", "BLF_TriangleWave", "BLF_BlitSawWave",
+      "WT_SineWave",
+      "WT_ImpulseWave", "WT_SquareWave", "WT_SawtoothWave", "WT_TriangleWave"
+   };
+   return (id >= Empty && id < NumWaveformIds) ? names[id] : "";
+}
+
+WaveEngine::WaveformId WaveEngine::findWaveform (const String& name) noexcept {
+   for (int id = Empty; id < NumWaveformIds; ++id) {
+      if (name.equalsIgnoreCase(getWaveformName((WaveformId) id))) {
+         return (WaveformId) id;
+      }
+   }
+   return NumWaveformIds;
+}
+
+const char* WaveEngine::getInterpolationName (WavetableOscillator::Interpolation interpolation) noexcept {
+   static const char* const names[] = {"Linear", "CubicHermite", "Lagrange", "WindowedSinc"};
+   return names[interpolation];
+}
+
+const char* WaveEngine::getQualityName (Quality quality) noexcept {
+   static const char* const names[] = {"Full", "Reduced", "Economy"};
+   return (quality >= FullQuality && quality < NumQualities) ? names[quality] : "";
+}
+
+int WaveEngine::findInterpolation (const String& name) noexcept {
+   for (int i = WavetableOscillator::Linear; i <= WavetableOscillator::WindowedSinc; ++i) {
+      if (name.equalsIgnoreCase(getInterpolationName((WavetableOscillator::Interpolation) i))) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+void WaveEngine::setWaveform (WaveformId newWaveform) noexcept {
+   fadeRemaining = 0;
+   pendingWaveform = NumWaveformIds;
+   playing->waveform = newWaveform;
+   playing->kernel = getKernel(newWaveform, interpolation, playing->quality);
+}
+
+void WaveEngine::setInterpolation (WavetableOscillator::Interpolation newInterpolation) noexcept {
+   interpolation = newInterpolation;
+   // the kernels choose the interpolation themselves, this keeps
+   // getNextSample() consistent with them
+   for (auto& voice : voices) {
+      for (auto& oscillator : voice.oscillators) {
+         oscillator.setInterpolation(interpolation);
+      }
+      voice.kernel = getKernel(voice.waveform, interpolation, voice.quality);
+   }
+}
+
+void WaveEngine::setDustBandLimited (bool shouldBandLimit) noexcept {
+   dustBandLimited = shouldBandLimit;
+   for (auto& voice : voices) {
+      for (auto& generator : voice.dustGenerators) {
+         generator.setBandLimited(dustBandLimited);
+      }
+   }
+}
+
+void WaveEngine::setLevel (double newLevel) noexcept {
+   levelSmoother.snap(newLevel);
+   playing->level = newLevel;
+}
+
+void WaveEngine::setFrequency (double newFrequency) noexcept {
+   frequencySmoother.snap(newFrequency);
+   playing->setFrequency(newFrequency);
+}
+
+void WaveEngine::apply (const ParameterQueue::Change& change) noexcept {
+   switch (change.parameter) {
+      case LevelParameter:     levelSmoother.setTarget(change.value);     break;
+      case FrequencyParameter:
+         frequencySmoother.setTarget(change.value);
+         // the cost may have changed, so the governor tries the better
+         // quality again soon
+         governor.resetHold();
+         break;
+      case WaveformParameter:
+         crossfadeTo((WaveformId) jlimit((int) Empty, NumWaveformIds - 1, (int) change.value));
+         governor.resetHold();
+         break;
+      case InterpolationParameter:
+         setInterpolation((WavetableOscillator::Interpolation) jlimit(0, 3, (int) change.value));
+         break;
+   }
+}
+
+// A switch during a crossfade waits for it to end, since cutting the voice
+// that is fading out would click unless it were already silent. Only the
+// latest waveform posted meanwhile is kept.
+void WaveEngine::crossfadeTo (WaveformId newWaveform) noexcept {
+   if (fadeRemaining > 0) {
+      pendingWaveform = newWaveform;
+      return;
+   }
+   pendingWaveform = NumWaveformIds;
+   if (newWaveform == playing->waveform) {
+      return;
+   }
+   startVoice(newWaveform, playing->quality);
+   // the LF_* waveforms continue in phase with each other
+   playing->phase.setPhase(fading->phase.getPhase());
+}
+
+// The additive waveforms change their number of harmonics between full and
+// reduced quality with the same kernel. During a crossfade the quality is
+// left as it is, and a later block applies the governor's level.
+void WaveEngine::changeQuality (Quality newQuality) noexcept {
+   if (newQuality == playing->quality || fadeRemaining > 0) {
+      return;
+   }
+   auto waveform = playing->waveform;
+   if (getKernel(waveform, interpolation, newQuality) == playing->kernel && !isAdditive(waveform)) {
+      playing->quality = newQuality;
+      return;
+   }
+   startVoice(waveform, newQuality);
+   playing->continueFrom(*fading);
+}
+
+// Callers wait for a running crossfade to end, so the voice swapped out is
+// silent.
+void WaveEngine::startVoice (WaveformId newWaveform, Quality newQuality) noexcept {
+   std::swap(playing, fading);
+   playing->reset();
+   playing->waveform = newWaveform;
+   playing->quality = newQuality;
+   playing->kernel = getKernel(newWaveform, interpolation, newQuality);
+   fadeRemaining = crossfadeSamples;
+}
+
+// The block is split at every posted change and, while a parameter glides
+// or the voices crossfade, into runs of at most smoothingRun samples.
+void WaveEngine::process (float* const* channels, int numChannels, int numSamples) noexcept {
+   auto startTicks = Time::getHighResolutionTicks();
+   auto crossfaded = fadeRemaining > 0;
+   auto blockTime = Time::getMillisecondCounterHiRes();
+   int numPending = 0;
+   while (numPending < (int) pending.size() && changes.pop(pending[(size_t) numPending])) {
+      ++numPending;
+   }
+   auto* bank = (sharedBank != nullptr) ? sharedBank : wavetableBuilder.acquireBank();
+   for (auto& voice : voices) {
+      voice.bank = bank;
+   }
+   for (int chan = maxChannels; chan < numChannels; ++chan) {
+      FloatVectorOperations::clear(channels[chan], numSamples);
+   }
+   numChannels = jmin(numChannels, maxChannels);
+   float* run[maxChannels];
+   int next = 0;
+   for (int start = 0; start < numSamples;) {
+      for (; next < numPending; ++next) {
+         auto& change = pending[(size_t) next];
+         if (ParameterQueue::getSampleOffset(change.time, previousBlockTime, sampleRate, numSamples) > start) {
+            break;
+         }
+         apply(change);
+      }
+      if (fadeRemaining == 0 && pendingWaveform != NumWaveformIds) {
+         crossfadeTo(pendingWaveform);
+      }
+      auto end = numSamples;
+      if (next < numPending) {
+         end = ParameterQueue::getSampleOffset(pending[(size_t) next].time, previousBlockTime, sampleRate, numSamples);
+      }
+      if (levelSmoother.isSmoothing() || frequencySmoother.isSmoothing() || fadeRemaining > 0) {
+         end = jmin(end, start + smoothingRun);
+      }
+      for (int chan = 0; chan < numChannels; ++chan) {
+         run[chan] = channels[chan] + start;
+      }
+      crossfaded = crossfaded || fadeRemaining > 0;
+      renderRun(run, numChannels, end - start);
+      start = end;
+   }
+   // changes that map past the end of the block
+   for (; next < numPending; ++next) {
+      apply(pending[(size_t) next]);
+   }
+   previousBlockTime = blockTime;
+   // a block that crossfaded rendered both voices, so its time is not the
+   // cost of the playing one
+   if (!crossfaded) {
+      changeQuality((Quality) governor.update(Time::getHighResolutionTicks() - startTicks, numSamples));
+   }
+}
+
+void WaveEngine::renderRun (float* const* channels, int numChannels, int numSamples) noexcept {
+   if (numChannels <= 0 || numSamples <= 0) {
+      return;
+   }
+   auto fade = fadeRemaining > 0;
+   auto runFrequency = frequencySmoother.getCurrent();
+   playing->setFrequency(runFrequency);
+   if (fade) {
+      fading->setFrequency(runFrequency);
+   }
+   frequencySmoother.advance(numSamples);
+   auto startLevel = levelSmoother.getCurrent();
+   auto endLevel = levelSmoother.advance(numSamples);
+   // with a level ramp, render at unit level and ramp the level afterwards
+   auto ramp = startLevel != endLevel;
+   playing->level = fading->level = ramp ? 1.0 : startLevel;
+   playing->kernel(*playing, channels, numChannels, numSamples);
+   if (fade) {
+      mixFadingVoice(channels, numChannels, numSamples);
+   }
+   if (ramp) {
+      auto gain = (float) startLevel;
+      auto step = (float) ((endLevel - startLevel) / numSamples);
+      for (int chan = 0; chan < numChannels; ++chan) {
+         auto* samples = channels[chan];
+         for (int i = 0; i < numSamples; ++i) {
+            samples[i] *= gain + step * (float) i;
+         }
+      }
+      playing->level = fading->level = endLevel;
+   }
+}
+
+// The voices are crossfaded linearly. Runs are at most smoothingRun samples
+// while fading, so the fading voice fits in the scratch buffer.
+void WaveEngine::mixFadingVoice (float* const* channels, int numChannels, int numSamples) noexcept {
+   jassert(numSamples <= smoothingRun);
+   float* faded[maxChannels];
+   for (int chan = 0; chan < numChannels; ++chan) {
+      faded[chan] = scratch.data() + chan * smoothingRun;
+   }
+   fading->kernel(*fading, faded, numChannels, numSamples);
+   auto step = 1.0f / (float) crossfadeSamples;
+   auto fadeIn = 1.0f - (float) fadeRemaining * step;
+   auto numFading = jmin(numSamples, fadeRemaining);
+   for (int chan = 0; chan < numChannels; ++chan) {
+      auto* samples = channels[chan];
+      auto* old = faded[chan];
+      for (int i = 0; i < numFading; ++i) {
+         auto gain = fadeIn + step * (float) i;
+         samples[i] = old[i] + gain * (samples[i] - old[i]);
+      }
+   }
+   fadeRemaining -= numFading;
+}
+
+void WaveEngine::fanOut (float* const* channels, int numChannels, int numSamples) noexcept {
+   for (int chan = 1; chan < numChannels; ++chan) {
+      FloatVectorOperations::copy(channels[chan], channels[0], numSamples);
+   }
+}
+
+//==============================================================================
+// Voice
+//==============================================================================
+
+WaveEngine::Voice::Voice() {
+   polyBlep.setPulseWidth(pulseWidth);
+}
+
+void WaveEngine::Voice::prepare (double newSampleRate, int numChannels, Random& random) {
+   sampleRate = newSampleRate;
+   additive.prepare(sampleRate);
+   noiseGenerator.setSeed((uint64) random.nextInt64());
+   // one dust and colored noise stream per output channel
+   dustGenerators.clear();
+   coloredNoises.clear();
+   for (int chan = 0; chan < jlimit(1, maxChannels, numChannels); ++chan) {
+      dustGenerators.emplace_back(random.nextInt64());
+      coloredNoises.emplace_back((uint64) random.nextInt64());
+      coloredNoises.back().prepare(sampleRate);
+   }
+   reset();
+}
+
+void WaveEngine::Voice::reset() noexcept {
+   phase.reset();
+   sine.reset();
+   additive.reset();
+   polyBlep.reset();
+   blit.reset();
+   for (auto& generator : dustGenerators) {
+      generator.reset();
+   }
+   for (auto& source : coloredNoises) {
+      source.reset();
+   }
+}
+
+void WaveEngine::Voice::continueFrom (const Voice& other) noexcept {
+   phase.setPhase(other.phase.getPhase());
+   auto table = getWavetable(waveform);
+   if (table < 0) {
+      return;
+   }
+   // the additive waveforms are read from their wavetables at economy quality
+   auto readsTable = [] (const Voice& voice) {
+      return voice.waveform >= WT_START || voice.quality == EconomyQuality;
+   };
+   auto cycle = readsTable(other) ? other.oscillators[(size_t) table].getPhase()
+      : (uint32) (other.additive.getPhase() * 4294967296.0);
+   if (readsTable(*this)) {
+      oscillators[(size_t) table].setPhase(cycle);
+   }
+   else {
+      additive.setPhase(cycle / 4294967296.0);
+   }
+}
+
+void WaveEngine::Voice::setFrequency (double newFrequency) noexcept {
+   if (newFrequency != frequency) {
+      frequency = newFrequency;
+      phase.setFrequency(frequency, sampleRate);
+   }
+}
+
+//==============================================================================
+// Noise
+//==============================================================================
+
+void WaveEngine::silence (Voice&, float* const* channels, int numChannels, int numSamples) noexcept {
+   for (int chan = 0; chan < numChannels; ++chan) {
+      FloatVectorOperations::clear(channels[chan], numSamples);
+   }
+}
+
+// Every channel is an independent stream at the same position.
+template <NoiseGenerator::Distribution distribution>
+void WaveEngine::whiteNoise (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto gain = (float) voice.level;
+   if (distribution == NoiseGenerator::Gaussian) {
+      gain *= gaussianScale;
+   }
+   auto& generator = voice.noiseGenerator;
+   generator.setDistribution(distribution);
+   for (int chan = 0; chan < numChannels; ++chan) {
+      generator.renderBlock((uint32) chan, channels[chan], numSamples, gain);
+   }
+   generator.advance(numSamples);
+}
+
+// Generates random uniform impulses, freq per second on average across all
+// channels. The generators only write the impulses, so each channel is
+// cleared first. Channels beyond the prepared ones stay silent.
+void WaveEngine::dust (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto numStreams = jmin(numChannels, (int) voice.dustGenerators.size());
+   for (int chan = 0; chan < numChannels; ++chan) {
+      FloatVectorOperations::clear(channels[chan], numSamples);
+   }
+   for (int chan = 0; chan < numStreams; ++chan) {
+      auto& generator = voice.dustGenerators[(size_t) chan];
+      generator.setDensity(voice.frequency / numChannels, voice.sampleRate);
+      generator.renderBlock(channels[chan], numSamples, (float) voice.level);
+   }
+}
+
+template <ColoredNoise::Color color>
+void WaveEngine::coloredNoise (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto numStreams = jmin(numChannels, (int) voice.coloredNoises.size());
+   for (int chan = 0; chan < numStreams; ++chan) {
+      auto& source = voice.coloredNoises[(size_t) chan];
+      source.setColor(color);
+      source.renderBlock(channels[chan], numSamples, (float) voice.level);
+   }
+   for (int chan = numStreams; chan < numChannels; ++chan) {
+      FloatVectorOperations::clear(channels[chan], numSamples);
+   }
+}
+
+//==============================================================================
+// Sine Wave
+//==============================================================================
+
+void WaveEngine::sineWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   voice.sine.setFrequency(voice.frequency, voice.sampleRate);
+   voice.sine.renderBlock(channels[0], nullptr, numSamples, (float) voice.level);
+   fanOut(channels, numChannels, numSamples);
+}
+
+//==============================================================================
+// Low Frequency Waveforms
+//==============================================================================
+
+// Each shape maps the phase of a sample, and the phase increment, to a value
+// from -1 to 1.
+
+// The first sample of a period is less than one increment past the wrap.
+struct WaveEngine::ImpulseShape {
+   static forcedinline float get (uint32 phase, uint32 increment) noexcept {
+      return (phase < increment) ? 1.0f : 0.0f;
+   }
+};
+
+// The top bit of the phase is set in the second half of the period.
+struct WaveEngine::SquareShape {
+   static forcedinline float get (uint32 phase, uint32) noexcept {
+      return (phase >> 31) ? 1.0f : -1.0f;
+   }
+};
+
+// Flipping the top bit and reading the phase as signed gives
+// (phase - 1/2) * 2^32, i.e. the phasor scaled by 2 and offset by 1.
+struct WaveEngine::SawtoothShape {
+   static forcedinline float get (uint32 phase, uint32) noexcept {
+      return (float) (int32) (phase ^ 0x80000000u) * (1.0f / 2147483648.0f);
+   }
+};
+
+// 1 - 4 * |phasor - 1/2|, rising in the first half and falling in the second.
+struct WaveEngine::TriangleShape {
+   static forcedinline float get (uint32 phase, uint32) noexcept {
+      auto centered = (int32) (phase ^ 0x80000000u);
+      return 1.0f - (float) std::abs((int64) centered) * (1.0f / 1073741824.0f);
+   }
+};
+
+template <typename Shape>
+void WaveEngine::lowFrequencyWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto* const output = channels[0];
+   auto gain = (float) voice.level;
+   auto current = voice.phase.getPhase();
+   auto increment = voice.phase.getIncrement();
+   for (int i = 0; i < numSamples; ++i) {
+      output[i] = Shape::get(current, increment) * gain;
+      current += increment;
+   }
+   voice.phase.setPhase(current);
+   fanOut(channels, numChannels, numSamples);
+}
+
+//==============================================================================
+// Band Limited Waveforms
+//==============================================================================
+
+// The harmonics are rotated recursively by the additive oscillator, so a
+// sample costs a few multiply-adds per harmonic instead of a std::sin() call.
+template <AdditiveOscillator::Spectrum spectrum>
+void WaveEngine::additiveWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   voice.additive.setSpectrum(spectrum);
+   voice.additive.setMaxHarmonic(voice.quality == FullQuality ? 0 : reducedHarmonics);
+   voice.additive.setFrequency(voice.frequency, voice.sampleRate);
+   voice.additive.renderBlock(channels[0], numSamples, (float) voice.level);
+   fanOut(channels, numChannels, numSamples);
+}
+
+// Square, sawtooth, pulse and triangle waves generated by the PolyBLEP
+// oscillator. Their discontinuities are smoothed by polynomial corrections
+// so the cost per sample does not depend on the number of harmonics.
+template <PolyBlepOscillator::Shape shape>
+void WaveEngine::polyBlepWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   voice.polyBlep.setShape(shape);
+   voice.polyBlep.setFrequency(voice.frequency, voice.sampleRate);
+   voice.polyBlep.renderBlock(channels[0], numSamples, (float) voice.level);
+   fanOut(channels, numChannels, numSamples);
+}
+
+// Band limited impulse train (BL_ImpulseWave) or its leaky integral, a
+// sawtooth (BLF_BlitSawWave).
+template <BlitOscillator::Shape shape>
+void WaveEngine::blitWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   voice.blit.setShape(shape);
+   voice.blit.setFrequency(voice.frequency, voice.sampleRate);
+   voice.blit.renderBlock(channels[0], numSamples, (float) voice.level);
+   fanOut(channels, numChannels, numSamples);
+}
+
+//==============================================================================
+// WaveTable Synthesis
+//==============================================================================
+
+// Silent until the first bank of wavetables has been built.
+template <WavetableBank::Waveform table, WavetableOscillator::Interpolation interpolation>
+void WaveEngine::wavetableWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto* bank = voice.bank;
+   if (bank == nullptr) {
+      silence(voice, channels, numChannels, numSamples);
+      return;
+   }
+   auto& oscillator = voice.oscillators[table];
+   oscillator.setWavetable(&bank->getTable(table));
+   oscillator.setFrequency((float) voice.frequency, (float) voice.sampleRate);
+   oscillator.template renderBlock<interpolation>(channels[0], numSamples, (float) voice.level);
+   fanOut(channels, numChannels, numSamples);
+}
+
+// The wavetable has the additive oscillator's spectrum, so it sounds much
+// the same at a fixed cost per sample. Its gain is undone so the level
+// matches too.
+template <WavetableBank::Waveform table, PolyBlepOscillator::Shape shape>
+void WaveEngine::economyWave (Voice& voice, float* const* channels, int numChannels, int numSamples) noexcept {
+   auto* bank = voice.bank;
+   if (bank == nullptr) {
+      polyBlepWave<shape>(voice, channels, numChannels, numSamples);
+      return;
+   }
+   auto& oscillator = voice.oscillators[table];
+   oscillator.setWavetable(&bank->getTable(table));
+   oscillator.setFrequency((float) voice.frequency, (float) voice.sampleRate);
+   auto gain = (float) voice.level / WavetableBank::getTableGain(table);
+   oscillator.template renderBlock<WavetableOscillator::Linear>(channels[0], numSamples, gain);
+   fanOut(channels, numChannels, numSamples);
+}
+
+//==============================================================================
+// Kernel table
+//==============================================================================
+
+// Every combination is instantiated here, which is the only place a
+// waveform is switched on. The interpolation only matters to the WT_*
+// waveforms, so the others have one kernel each. Below full quality the
+// WT_* waveforms use a lower interpolation order and the additive waveforms
+// have an economy kernel.
+WaveEngine::Kernel WaveEngine::getKernel (WaveformId id, WavetableOscillator::Interpolation interpolation,
+                                          Quality quality) noexcept {
+   using Table = WavetableBank;
+   using Oscillator = WavetableOscillator;
+   static const Kernel kernels[NumWaveformIds] {
+      silence,
+      whiteNoise<NoiseGenerator::Uniform>,
+      coloredNoise<ColoredNoise::Brown>,
+      dust,
+      whiteNoise<NoiseGenerator::Gaussian>,
+      coloredNoise<ColoredNoise::Pink>,
+      coloredNoise<ColoredNoise::Blue>,
+      coloredNoise<ColoredNoise::Violet>,
+      sineWave,
+      lowFrequencyWave<ImpulseShape>,
+      lowFrequencyWave<SquareShape>,
+      lowFrequencyWave<SawtoothShape>,
+      lowFrequencyWave<TriangleShape>,
+      blitWave<BlitOscillator::Impulse>,
+      additiveWave<AdditiveOscillator::Square>,
+      additiveWave<AdditiveOscillator::Sawtooth>,
+      additiveWave<AdditiveOscillator::Triangle>,
+      polyBlepWave<PolyBlepOscillator::Square>,
+      polyBlepWave<PolyBlepOscillator::Sawtooth>,
+      polyBlepWave<PolyBlepOscillator::Pulse>,
+      polyBlepWave<PolyBlepOscillator::Triangle>,
+      blitWave<BlitOscillator::Sawtooth>
+   };
+   static const Kernel wavetableKernels[Table::NumWaveforms][4] {
+#define WAVETABLE_KERNELS(table) \
+      { wavetableWave<table, Oscillator::Linear>, wavetableWave<table, Oscillator::CubicHermite>, \
+        wavetableWave<table, Oscillator::Lagrange>, wavetableWave<table, Oscillator::WindowedSinc> }
+      WAVETABLE_KERNELS(Table::Sine),
+      WAVETABLE_KERNELS(Table::Impulse),
+      WAVETABLE_KERNELS(Table::Square),
+      WAVETABLE_KERNELS(Table::Sawtooth),
+      WAVETABLE_KERNELS(Table::Triangle)
+#undef WAVETABLE_KERNELS
+   };
+   static const Kernel economyKernels[] {
+      economyWave<Table::Square, PolyBlepOscillator::Square>,
+      economyWave<Table::Sawtooth, PolyBlepOscillator::Sawtooth>,
+      economyWave<Table::Triangle, PolyBlepOscillator::Triangle>
+   };
+   if (id >= WT_START && id < NumWaveformIds) {
+      auto order = (quality == FullQuality) ? (int) interpolation
+         : (quality == ReducedQuality) ? jmax(0, (int) interpolation - 1) : (int) Oscillator::Linear;
+      return wavetableKernels[id - WT_START][order];
+   }
+   if (isAdditive(id) && quality == EconomyQuality) {
+      return economyKernels[id - BL_SquareWave];
+   }
+   return (id >= Empty && id < WT_START) ? kernels[id] : silence;
+}
+
+int WaveEngine::getWavetable (WaveformId id) noexcept {
+   switch (id) {
+      case BL_SquareWave:   return WavetableBank::Square;
+      case BL_SawtoothWave: return WavetableBank::Sawtooth;
+      case BL_TriangeWave:  return WavetableBank::Triangle;
+      default:
+         return (id >= WT_START && id < NumWaveformIds) ? id - WT_START : -1;
+   }
+}
@@ -0,0 +1,395 @@
+//==============================================================================
+// WaveEngine.h
+// The app's waveform generators and the kernels that render them.
+//==============================================================================
+
+#pragma once
+
+#include "WavetableOscillator.h"
+#include "WavetableBank.h"
+#include "AdditiveOscillator.h"
+#include "PolyBlepOscillator.h"
+#include "BlitOscillator.h"
+#include "NoiseGenerator.h"
+#include "DustGenerator.h"
+#include "ColoredNoise.h"
+#include "SineOscillator.h"
+#include "PhaseAccumulator.h"
+#include "ParameterQueue.h"
+#include "SmoothedParameter.h"
+#include "QualityGovernor.h"
+
+/// WaveEngine owns every generator the app can play and renders the selected
+/// waveform into a set of channels. It has no GUI or device dependencies.
+///
+/// Each waveform is rendered by a kernel, a function template specialized at
+/// compile time for the waveform (and, for the WT_* waveforms, for the
+/// interpolation), so the sample loops contain no waveform or interpolation
+/// branches. setWaveform() and setInterpolation() look the kernel up in a
+/// table of function pointers; process() just calls it. Every kernel
+/// overwrites the channels, so they need not be cleared first. Periodic
+/// waveforms are the same in every channel and are rendered once into the
+/// first channel and copied to the others. Noise is rendered per channel so
+/// the channels are independent.
+///
+/// While the engine renders on the audio thread, other threads change its
+/// parameters only through post(), which queues the change without locking.
+/// process() applies the queued changes at their sample offsets within the
+/// block (see ParameterQueue) and splits the block at them. The level glides
+/// linearly and the frequency exponentially to new values (see
+/// SmoothedParameter). While either is gliding the block is rendered in
+/// short runs at the current frequency, with the level ramped sample by
+/// sample. The setters apply a value at once, without smoothing, and are
+/// for use when the engine is not rendering, e.g. when rendering offline.
+///
+/// The generators and their state are held by a Voice, and the engine has
+/// two. A waveform posted while rendering starts in the idle voice, from the
+/// start of its period, and the engine crossfades from the playing voice to
+/// it over a short window, so switching waveforms never clicks. A waveform
+/// posted during a crossfade starts when it ends. The voice that faded out
+/// keeps its generators for the next switch, so switching neither allocates
+/// nor frees memory on the audio thread. The wavetable bank is acquired once
+/// per block and shared by both voices.
+///
+/// When its governor is enabled the engine times each block and lowers the
+/// quality it renders at when rendering comes close to the deadline (see
+/// QualityGovernor and Quality), so that a costly waveform sounds duller
+/// instead of dropping out. A change of quality starts the same waveform in
+/// the idle voice, in phase with the playing one, and crossfades to it like
+/// a change of waveform. The governor does not see the blocks that
+/// crossfade, which render both voices, and the quality does not change
+/// during a crossfade.
+
+class WaveEngine
+{
+public:
+  /// Enumeration identifying all the different waveforms the engine
+  /// generates. The Empty value indicate that no waveform has
+  /// been selected.
+  enum WaveformId {
+    Empty, WhiteNoise,  BrownNoise, DustNoise, GaussianNoise, PinkNoise, BlueNoise, VioletNoise,
+    SineWave,
+    LF_ImpulseWave, LF_SquareWave, LF_SawtoothWave, LF_TriangeWave,
+    BL_ImpulseWave, BL_SquareWave, BL_SawtoothWave, BL_TriangeWave,
+    BLF_SquareWave, BLF_SawtoothWave, BLF_PulseWave, BLF_TriangleWave, BLF_BlitSawWave,
+    WT_SineWave,
+    WT_ImpulseWave, WT_SquareWave, WT_SawtoothWave, WT_TriangleWave,
+    NumWaveformIds,
+    WT_START = WT_SineWave
+  };
+
+  /// The parameters that post() can change.
+  enum Parameter { LevelParameter, FrequencyParameter, WaveformParameter, InterpolationParameter };
+
+  /// The qualities the governor renders at, from the best to the cheapest.
+  /// Only the BL_* additive waveforms (square, sawtooth and triangle) and
+  /// the WT_* waveforms have cheaper versions.
+  enum Quality {
+    FullQuality,     ///< Every waveform as selected.
+    ReducedQuality,  ///< The additive waveforms up to reducedHarmonics, the WT_* waveforms one interpolation order lower.
+    EconomyQuality,  ///< The additive waveforms read from the wavetables of the same spectra, the WT_* waveforms with linear interpolation.
+    NumQualities
+  };
+
+  /// The highest harmonic of the additive waveforms at ReducedQuality.
+  static constexpr int reducedHarmonics = 64;
+
+  /// The most channels process() writes. Further channels are cleared.
+  static constexpr int maxChannels = 32;
+
+  WaveEngine();
+
+  /// Prepares the generators for sampleRate and numChannels output channels
+  /// and resets their phases. Every noise stream is seeded from seed, so the
+  /// same seed renders the same noise, whichever thread the engine runs on.
+  /// Allocates, so call it before rendering starts.
+  void prepare (double sampleRate, int numChannels, int64 seed = 0);
+
+  /// Requests wavetables of tableSize samples, a power of two. They are built
+  /// in the background and the WT_* waveforms are silent until they are
+  /// ready. Call from the message thread.
+  void requestWavetables (int tableSize);
+
+  /// Waits for the requested wavetables to be built, for at most
+  /// timeoutMilliseconds (-1 waits forever). Returns true if they are ready.
+  bool waitForWavetables (int timeoutMilliseconds = -1) const { return wavetableBuilder.waitForBuild (timeoutMilliseconds); }
+
+  /// Makes the WT_* waveforms read bank instead of the engine's own
+  /// wavetables, so that engines rendering offline side by side can share
+  /// one bank rather than each building its own. The caller keeps bank alive
+  /// while the engine renders. nullptr returns to the engine's own tables.
+  /// Call before rendering starts.
+  void setWavetables (const WavetableBank* bank) noexcept { sharedBank = bank; }
+
+  /// Deletes the wavetables the audio thread has stopped using. Call from
+  /// the message thread.
+  void collectGarbage();
+
+  /// Queues a change of parameter to value, to be applied by the next
+  /// process(). Call from one thread (normally the message thread) while the
+  /// engine renders on another. Returns false if the queue was full.
+  bool post (Parameter parameter, double value) noexcept { return changes.push (parameter, value); }
+
+  /// Selects the waveform and its kernel.
+  void setWaveform (WaveformId newWaveform) noexcept;
+  WaveformId getWaveform() const noexcept { return playing->waveform; }
+
+  /// Selects the interpolation of the WT_* waveforms.
+  void setInterpolation (WavetableOscillator::Interpolation newInterpolation) noexcept;
+  WavetableOscillator::Interpolation getInterpolation() const noexcept { return interpolation; }
+
+  /// Selects single sample or band limited impulses for DustNoise (see
+  /// DustGenerator). They are single samples at first.
+  void setDustBandLimited (bool shouldBandLimit) noexcept;
+  bool isDustBandLimited() const noexcept { return dustBandLimited; }
+
+  /// Sets the output amplitude (0 to 1).
+  void setLevel (double newLevel) noexcept;
+  double getLevel() const noexcept { return levelSmoother.getTarget(); }
+
+  /// Sets the frequency in hertz. For DustNoise it is the number of
+  /// impulses per second, spread over all channels.
+  void setFrequency (double newFrequency) noexcept;
+  double getFrequency() const noexcept { return frequencySmoother.getTarget(); }
+
+  double getSampleRate() const noexcept { return sampleRate; }
+
+  /// Enables or disables the governor. While it is disabled the engine
+  /// renders at FullQuality. It is disabled at first. May be called from
+  /// any thread.
+  void setGovernorEnabled (bool shouldBeEnabled) noexcept { governor.setEnabled (shouldBeEnabled); }
+  bool isGovernorEnabled() const noexcept { return governor.isEnabled(); }
+
+  /// Sets the fraction of each block's deadline the engine may take to
+  /// render it before the governor lowers the quality. May be called from
+  /// any thread.
+  void setCpuBudget (double fraction) noexcept { governor.setBudget (fraction); }
+
+  /// Returns the quality the governor has chosen. May be called from any thread.
+  Quality getQuality() const noexcept { return (Quality) governor.getLevel(); }
+
+  /// Returns the name of a quality, e.g. "Reduced".
+  static const char* getQualityName (Quality quality) noexcept;
+
+  /// Sets the length of the crossfade between waveforms posted while
+  /// rendering. Takes effect at the next prepare().
+  void setCrossfadeTime (double seconds) noexcept { crossfadeSeconds = jmax (0.0, seconds); }
+
+  /// Returns the name of a waveform, the same as its enumerator (e.g.
+  /// "WT_SawtoothWave").
+  static const char* getWaveformName (WaveformId id) noexcept;
+
+  /// Returns the waveform with a name (ignoring case), or NumWaveformIds if
+  /// there is none.
+  static WaveformId findWaveform (const String& name) noexcept;
+
+  /// Returns the name of an interpolation, the same as its enumerator.
+  static const char* getInterpolationName (WavetableOscillator::Interpolation interpolation) noexcept;
+
+  /// Returns the interpolation with a name (ignoring case), or -1 if there
+  /// is none.
+  static int findInterpolation (const String& name) noexcept;
+
+  /// Returns true if the waveform uses the frequency.
+  static bool hasFrequency (WaveformId id) noexcept
+  {
+    return ! (id >= WhiteNoise && id < SineWave && id != DustNoise);
+  }
+
+  /// Overwrites numSamples of each of numChannels channels with the selected
+  /// waveform, after applying the changes posted since the last call.
+  void process (float* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+  struct Voice;
+  using Kernel = void (*) (Voice&, float* const*, int, int);
+
+  /// A complete set of generators playing one waveform, with the parameters
+  /// its kernel renders with.
+  struct Voice
+  {
+    Voice();
+
+    /// Allocates the per channel generators, seeds the noise sources from
+    /// random and resets the voice.
+    void prepare (double sampleRate, int numChannels, Random& random);
+
+    /// Restarts every generator from the start of its period.
+    void reset() noexcept;
+
+    /// Continues the waveform other is playing in phase, after a change of
+    /// quality. The LF_* waveforms share a phase, and the additive
+    /// oscillator and a wavetable of the same spectrum have the same phase.
+    void continueFrom (const Voice& other) noexcept;
+
+    /// Sets the frequency the kernel renders with.
+    void setFrequency (double newFrequency) noexcept;
+
+    WaveformId waveform = Empty;
+    Quality quality = FullQuality;
+    Kernel kernel = silence;
+    double sampleRate = 0.0, level = 0.0, frequency = 0.0;
+    /// The wavetables of the current block, or nullptr until they are built.
+    const WavetableBank* bank = nullptr;
+
+    /// The phase of the LF_* waveforms, a fixed point fraction of a period
+    /// that wraps on overflow.
+    PhaseAccumulator phase;
+
+    /// The recursive sine oscillator used by SineWave.
+    SineOscillator sine;
+
+    /// The additive synthesis engine used by the BL_* waveforms.
+    AdditiveOscillator additive;
+
+    /// The PolyBLEP oscillator used by the BLF_* waveforms.
+    PolyBlepOscillator polyBlep;
+
+    /// The closed form impulse train used by BL_ImpulseWave and BLF_BlitSawWave.
+    BlitOscillator blit;
+
+    /// The block based noise source used by WhiteNoise and GaussianNoise. Each
+    /// channel is its own stream.
+    NoiseGenerator noiseGenerator;
+
+    /// The impulse schedulers used by DustNoise, one per output channel.
+    std::vector<DustGenerator> dustGenerators;
+
+    /// The colored noise sources used by BrownNoise, PinkNoise, BlueNoise and
+    /// VioletNoise, one per output channel.
+    std::vector<ColoredNoise> coloredNoises;
+
+    /// One wavetable oscillator per WavetableBank::Waveform.
+    std::array<WavetableOscillator, WavetableBank::NumWaveforms> oscillators;
+  };
+
+  /// The longest run rendered with constant parameters while one is gliding
+  /// or the voices crossfade.
+  static constexpr int smoothingRun = 32;
+
+  /// Applies a posted change.
+  void apply (const ParameterQueue::Change& change) noexcept;
+
+  /// Starts newWaveform in the idle voice and fades over to it, or during a
+  /// crossfade makes it the waveform to start when the crossfade ends.
+  void crossfadeTo (WaveformId newWaveform) noexcept;
+
+  /// Renders the playing waveform at newQuality from now on, crossfading if
+  /// that changes how it is rendered.
+  void changeQuality (Quality newQuality) noexcept;
+
+  /// Swaps the voices and starts newWaveform at newQuality in the playing one.
+  void startVoice (WaveformId newWaveform, Quality newQuality) noexcept;
+
+  /// Renders numSamples at the smoothed parameters' current values and
+  /// advances them.
+  void renderRun (float* const* channels, int numChannels, int numSamples) noexcept;
+
+  /// Renders the fading voice into the scratch buffer and mixes it with the
+  /// playing voice's channels, advancing the crossfade.
+  void mixFadingVoice (float* const* channels, int numChannels, int numSamples) noexcept;
+
+  static Kernel getKernel (WaveformId id, WavetableOscillator::Interpolation interpolation, Quality quality) noexcept;
+
+  /// Returns the WavetableBank::Waveform a waveform can be read from (the
+  /// WT_* waveforms and the additive BL_* waveforms), or -1 if there is none.
+  static int getWavetable (WaveformId id) noexcept;
+
+  /// Returns true for the BL_* waveforms rendered by the additive oscillator.
+  static bool isAdditive (WaveformId id) noexcept { return id >= BL_SquareWave && id <= BL_TriangeWave; }
+
+  /// Copies the first channel to the others.
+  static void fanOut (float* const* channels, int numChannels, int numSamples) noexcept;
+
+  //==============================================================================
+  // Kernels
+
+  static void silence (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <NoiseGenerator::Distribution distribution>
+  static void whiteNoise (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  static void dust (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <ColoredNoise::Color color>
+  static void coloredNoise (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  static void sineWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  /// Shape is one of the LF_* shapes below, which map a phase to a sample.
+  template <typename Shape>
+  static void lowFrequencyWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <AdditiveOscillator::Spectrum spectrum>
+  static void additiveWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <PolyBlepOscillator::Shape shape>
+  static void polyBlepWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <BlitOscillator::Shape shape>
+  static void blitWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  template <WavetableBank::Waveform table, WavetableOscillator::Interpolation interpolation>
+  static void wavetableWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  /// An additive waveform at EconomyQuality: table read with linear
+  /// interpolation or, until the wavetables are built, shape.
+  template <WavetableBank::Waveform table, PolyBlepOscillator::Shape shape>
+  static void economyWave (Voice&, float* const* channels, int numChannels, int numSamples) noexcept;
+
+  struct ImpulseShape;
+  struct SquareShape;
+  struct SawtoothShape;
+  struct TriangleShape;
+
+  //==============================================================================
+  WavetableOscillator::Interpolation interpolation = WavetableOscillator::CubicHermite;
+  bool dustBandLimited = false;
+  double sampleRate = 0.0;
+
+  SmoothedParameter levelSmoother {SmoothedParameter::Linear, 0.02};
+  SmoothedParameter frequencySmoother {SmoothedParameter::Exponential, 0.01};
+
+  /// The changes posted to the audio thread, the changes popped for the
+  /// current block and the time the previous block started.
+  ParameterQueue changes;
+  std::array<ParameterQueue::Change, ParameterQueue::capacity> pending;
+  double previousBlockTime = 0.0;
+
+  /// Seeds the voices' noise streams, itself seeded by prepare(). It is
+  /// given a seed here because Random's default constructor reads a global
+  /// seed that is not thread safe.
+  Random random {0};
+
+  /// The playing voice and the one fading out (or idle).
+  std::array<Voice, 2> voices;
+  Voice* playing = &voices[0];
+  Voice* fading = &voices[1];
+
+  /// The crossfade length, and the samples of it still to play.
+  double crossfadeSeconds = 0.01;
+  int crossfadeSamples = 1, fadeRemaining = 0;
+
+  /// The waveform posted during the crossfade, or NumWaveformIds if none.
+  WaveformId pendingWaveform = NumWaveformIds;
+
+  /// The fading voice is rendered here, smoothingRun samples per channel.
+  std::array<float, maxChannels * smoothingRun> scratch;
+
+  /// Builds the wavetables in the background and hands them to the audio thread.
+  WavetableBuilder wavetableBuilder;
+  /// The bank given to setWavetables(), or nullptr.
+  const WavetableBank* sharedBank = nullptr;
+
+  /// Chooses the quality from the time each block took.
+  QualityGovernor governor {NumQualities};
+
+  /// The Gaussian noise is scaled so its peaks rarely exceed the level (a
+  /// sample beyond 4 standard deviations occurs about once in 16000).
+  static constexpr float gaussianScale = 0.25f;
+
+  /// The duty cycle of the BL Fast Pulse waveform.
+  static constexpr double pulseWidth = 0.25;
+
+  JUCE_DECLARE_NON_COPYABLE (WaveEngine)
+};
@@ -0,0 +1,104 @@
+//==============================================================================
+// WaveformDisplay.cpp
+//==============================================================================
+
+#include "WaveformDisplay.h"
+
+WaveformDisplay::WaveformDisplay() {
+   setOpaque(true);
+   startTimerHz(30);
+}
+
+WaveformDisplay::~WaveformDisplay() {
+   stopTimer();
+}
+
+void WaveformDisplay::setViewLength(double numSamples) {
+   auto shortest = (double) peakFifo.getSamplesPerPeak() * jmax(1, getWidth());
+   viewLength = jlimit(shortest, jmax(shortest, getMaximumViewLength()), numSamples);
+   repaint();
+}
+
+double WaveformDisplay::getMaximumViewLength() const noexcept {
+   auto topLevel = pyramid.getNumLevels() - 1;
+   return (double) peakFifo.getSamplesPerPeak() * (double) (int64(1) << topLevel) * pyramid.getCapacity();
+}
+
+void WaveformDisplay::setColours(Colour backgroundColour, Colour waveformColour) {
+   background = backgroundColour;
+   waveform = waveformColour;
+   repaint();
+}
+
+//==============================================================================
+// Component overrides
+//==============================================================================
+
+void WaveformDisplay::paint(Graphics& g) {
+   g.fillAll(background);
+   auto width = getWidth();
+   if (width <= 0) {
+      return;
+   }
+   // pick the finest level with no more than two frames per pixel
+   auto framesPerPixel = viewLength / (peakFifo.getSamplesPerPeak() * width);
+   int level = 0;
+   while (level + 1 < pyramid.getNumLevels() && framesPerPixel >= 2.0) {
+      framesPerPixel *= 0.5;
+      ++level;
+   }
+   g.setColour(waveform);
+   auto numChannels = jmax(1, peakFifo.getNumChannels());
+   auto area = getLocalBounds().toFloat();
+   auto stripHeight = area.getHeight() / numChannels;
+   for (int chan = 0; chan < numChannels; ++chan) {
+      paintChannel(g, area.removeFromTop(stripHeight), chan, level, framesPerPixel);
+   }
+}
+
+void WaveformDisplay::paintChannel(Graphics& g, Rectangle<float> area, int channel, int level, double framesPerPixel) {
+   // the newest frame is drawn at the right edge, pixels with no history
+   // yet are left blank
+   auto end = pyramid.getNumFrames(level);
+   auto oldest = jmax(int64(0), end - pyramid.getCapacity());
+   auto width = (int) area.getWidth();
+   auto left = (int) area.getX();
+   auto centre = area.getCentreY();
+   auto halfHeight = area.getHeight() * 0.5f;
+   for (int x = 0; x < width; ++x) {
+      auto first = end - (int64) std::ceil((width - x) * framesPerPixel);
+      auto last = jmax(first + 1, end - (int64) std::ceil((width - x - 1) * framesPerPixel));
+      if (first < oldest) {
+         continue;
+      }
+      auto low = 1.0f, high = -1.0f;
+      for (auto index = first; index < last; ++index) {
+         auto& peak = pyramid.getFrame(level, index).peaks[(size_t) channel];
+         low = jmin(low, peak.min);
+         high = jmax(high, peak.max);
+      }
+      auto top = centre - jlimit(-1.0f, 1.0f, high) * halfHeight;
+      auto bottom = centre - jlimit(-1.0f, 1.0f, low) * halfHeight;
+      g.drawVerticalLine(left + x, top, jmax(top + 1.0f, bottom));
+   }
+}
+
+void WaveformDisplay::mouseWheelMove(const MouseEvent&, const MouseWheelDetails& wheel) {
+   // wheel up zooms in
+   setViewLength(viewLength * std::pow(2.0, -4.0 * wheel.deltaY));
+}
+
+//==============================================================================
+// Timer overrides
+//==============================================================================
+
+void WaveformDisplay::timerCallback() {
+   bool pulled = false;
+   peakFifo.pull([this, &pulled] (const PeakFifo::Frame& frame) {
+      pyramid.add(frame);
+      pulled = true;
+   });
+   if (pulled) {
+      repaint();
+   }
+}
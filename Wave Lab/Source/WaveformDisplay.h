@@ -0,0 +1,58 @@
+//==============================================================================
+// WaveformDisplay.h
+// A zoomable display of the output's recent waveform.
+//==============================================================================
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "PeakPyramid.h"
+
+/// WaveformDisplay draws the most recent stretch of the audio output, one
+/// strip per channel, as a vertical min/max line per pixel. The audio thread
+/// hands it the output with pushSamples(), which only decimates the samples
+/// into a PeakFifo. A timer on the message thread drains the fifo into a
+/// PeakPyramid and repaints, and paint() reads the pyramid level whose
+/// frames are nearest to, but no larger than, a pixel. The mouse wheel zooms
+/// the view from a single peak per pixel to the full history of the pyramid.
+
+class WaveformDisplay : public Component, private Timer
+{
+public:
+  WaveformDisplay();
+
+  ~WaveformDisplay() override;
+
+  /// Called on the audio thread with each block of output. Wait-free.
+  void pushSamples (const float* const* channels, int numChannels, int numSamples) noexcept
+  {
+    peakFifo.push (channels, numChannels, numSamples);
+  }
+
+  /// Sets the number of samples across the width of the display.
+  void setViewLength (double numSamples);
+  double getViewLength() const noexcept { return viewLength; }
+
+  /// Returns the longest view the history can fill.
+  double getMaximumViewLength() const noexcept;
+
+  void setColours (Colour backgroundColour, Colour waveformColour);
+
+  void paint (Graphics& g) override;
+
+  /// Zooms in or out by a factor of two per wheel notch.
+  void mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel) override;
+
+private:
+  void timerCallback() override;
+
+  /// Draws one channel's strip of the view from a level of the pyramid.
+  void paintChannel (Graphics& g, Rectangle<float> area, int channel, int level, double framesPerPixel);
+
+  PeakFifo peakFifo;
+  PeakPyramid pyramid;
+  double viewLength = 4096.0;
+  Colour background {Colours::black}, waveform {Colours::white};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
+};
@@ -0,0 +1,133 @@
+//==============================================================================
+// WavetableBank.cpp
+//==============================================================================
+
+#include "WavetableBank.h"
+#include "SpectralTableBuilder.h"
+
+//==============================================================================
+// WavetableBank
+//==============================================================================
+
+int WavetableBank::getNumLevels (int waveform, int tableSize) {
+   return (waveform == Sine) ? 1 : MipmappedWavetable::getMaxNumLevels(tableSize);
+}
+
+void WavetableBank::loadOrCreateTable (int waveform, const WavetableCache& cache) {
+   auto& table = tables[(size_t) waveform];
+   if (! cache.load(table, waveform, tableSize, getNumLevels(waveform, tableSize), generatorVersion)) {
+      createTable(waveform);
+      cache.save(table, waveform, generatorVersion);
+   }
+}
+
+void WavetableBank::createTable (int waveform) {
+   auto& table = tables[(size_t) waveform];
+   switch (waveform) {
+      case Sine:     createSineTable(table, tableSize);     break;
+      case Impulse:  createImpulseTable(table, tableSize);  break;
+      case Square:   createSquareTable(table, tableSize);   break;
+      case Sawtooth: createSawtoothTable(table, tableSize); break;
+      case Triangle: createTriangleTable(table, tableSize); break;
+   }
+}
+
+// Fills every level of waveTable from spectrum, each level limited to its
+// number of harmonics. Every level is one inverse FFT.
+static void createLevels(MipmappedWavetable& waveTable, int tableSize, int numLevels,
+                         const HarmonicSpectrum& spectrum, bool normalizeByHarmonics, float gain) {
+   waveTable.setSize (tableSize, numLevels);
+   SpectralTableBuilder builder (tableSize);
+   for (auto level = 0; level < waveTable.getNumLevels(); ++level) {
+      auto numHarmonic = waveTable.getNumHarmonics(level);
+      auto levelGain = normalizeByHarmonics ? gain / numHarmonic : gain;
+      builder.render(spectrum, numHarmonic, levelGain, waveTable.getWritePointer (level));
+      waveTable.updateGuardSamples(level);
+   }
+}
+
+// Create a sine wave table. A sine has only one harmonic so it needs only
+// one level.
+void WavetableBank::createSineTable(MipmappedWavetable& waveTable, int tableSize) {
+  HarmonicSpectrum spectrum (1);
+  spectrum.setHarmonic(1, 1.0f);
+  createLevels(waveTable, tableSize, getNumLevels(Sine, tableSize), spectrum, false, 1.0f);
+}
+
+// Create an impulse wave table, all harmonics at equal amplitude
+void WavetableBank::createImpulseTable(MipmappedWavetable& waveTable, int tableSize) {
+   HarmonicSpectrum spectrum (tableSize / 2);
+   for (auto u = 1; u <= spectrum.getNumHarmonics(); ++u) {
+      spectrum.setHarmonic(u, 1.0f);
+   }
+   createLevels(waveTable, tableSize, 0, spectrum, true, 1.0f);
+}
+
+// Create a square wave table, odd harmonics at 1/harmonic amplitude
+void WavetableBank::createSquareTable(MipmappedWavetable& waveTable, int tableSize) {
+   HarmonicSpectrum spectrum (tableSize / 2);
+   for (auto u = 1; u <= spectrum.getNumHarmonics(); u += 2) {
+      spectrum.setHarmonic(u, 1.0f / u);
+   }
+   createLevels(waveTable, tableSize, 0, spectrum, false, 1.0f);
+}
+
+// Create a sawtooth wave table, all harmonics at 1/harmonic amplitude
+void WavetableBank::createSawtoothTable(MipmappedWavetable& waveTable, int tableSize) {
+   HarmonicSpectrum spectrum (tableSize / 2);
+   for (auto u = 1; u <= spectrum.getNumHarmonics(); ++u) {
+      spectrum.setHarmonic(u, 1.0f / u);
+   }
+   createLevels(waveTable, tableSize, 0, spectrum, false, getTableGain(Sawtooth));
+}
+
+// Create a triagle wave table, odd harmonics at 1/harmonic**2 amplitude
+void WavetableBank::createTriangleTable(MipmappedWavetable& waveTable, int tableSize) {
+   HarmonicSpectrum spectrum (tableSize / 2);
+   for (auto u = 1; u <= spectrum.getNumHarmonics(); u += 2) {
+      spectrum.setHarmonic(u, 1.0f / ((float) u * u));
+   }
+   createLevels(waveTable, tableSize, 0, spectrum, false, 1.0f);
+}
+
+//==============================================================================
+// WavetableBuilder
+//==============================================================================
+
+/// The state shared by the jobs building one bank. The last job to finish
+/// publishes the bank.
+struct WavetableBuilder::Build
+{
+  Build (int tableSize, int buildGeneration)
+  : bank (std::make_unique<WavetableBank>(tableSize)), generation (buildGeneration) {}
+
+  std::unique_ptr<WavetableBank> bank;
+  const int generation;
+  std::atomic<int> remaining {WavetableBank::NumWaveforms};
+};
+
+WavetableBuilder::~WavetableBuilder() {
+   if (pool != nullptr) {
+      pool->removeAllJobs(false, -1);
+   }
+}
+
+void WavetableBuilder::requestBuild (int tableSize) {
+   if (tableSize == requestedTableSize)
+      return;
+   requestedTableSize = tableSize;
+   if (pool == nullptr) {
+      pool = std::make_unique<ThreadPool>(jmax(1, jmin((int) WavetableBank::NumWaveforms, SystemStats::getNumCpus())));
+   }
+   built.reset();
+   auto build = std::make_shared<Build>(tableSize, ++generation);
+   for (auto waveform = 0; waveform < WavetableBank::NumWaveforms; ++waveform) {
+      pool->addJob([this, build, waveform] {
+         build->bank->loadOrCreateTable(waveform, cache);
+         if (--build->remaining == 0 && build->generation == generation.load()) {
+            banks.publish(std::move(build->bank));
+            built.signal();
+         }
+      });
+   }
+}
@@ -0,0 +1,106 @@
+//==============================================================================
+// WavetableBank.h
+// This file defines the app's set of wavetables and their background builder.
+//==============================================================================
+
+#pragma once
+
+#include "MipmappedWavetable.h"
+#include "WavetableCache.h"
+#include "AtomicSnapshot.h"
+
+/// A WavetableBank holds a complete, immutable set of the app's wavetables
+/// for one table size. Banks are built by a WavetableBuilder and handed to
+/// the audio thread whole, so the audio thread never sees a table that is
+/// being written.
+struct WavetableBank
+{
+  /// The waveforms in a bank, in the same order as the WT_* menu items.
+  enum Waveform { Sine, Impulse, Square, Sawtooth, Triangle, NumWaveforms };
+
+  explicit WavetableBank (int size) : tableSize (size) {}
+
+  const MipmappedWavetable& getTable (int waveform) const { return tables[(size_t) waveform]; }
+
+  /// The version of the table builders. Increment it whenever a builder's
+  /// output changes so that cached tables are rebuilt.
+  static constexpr uint32 generatorVersion = 1;
+
+  /// Returns the gain a waveform's spectrum is scaled by in its table, which
+  /// is 1 except for the sawtooth, whose peaks would otherwise exceed 1.
+  static float getTableGain (int waveform) noexcept { return (waveform == Sawtooth) ? 1.0f / 1.6f : 1.0f; }
+
+  /// Returns the number of levels in the table for waveform.
+  static int getNumLevels (int waveform, int tableSize);
+
+  /// Fills the table for waveform with tableSize samples.
+  void createTable (int waveform);
+
+  /// Maps the table for waveform from cache or, if it is missing or stale,
+  /// builds it and writes it to cache.
+  void loadOrCreateTable (int waveform, const WavetableCache& cache);
+
+  /// The wavetable builders define their waveform's harmonic spectrum and
+  /// fill every level of a MipmappedWavetable with one period of it, limited
+  /// to the level's number of harmonics, using an inverse FFT per level.
+  /// tableSize must be a power of two.
+  static void createSineTable (MipmappedWavetable& waveTable, int tableSize);
+  static void createImpulseTable (MipmappedWavetable& waveTable, int tableSize);
+  static void createSquareTable (MipmappedWavetable& waveTable, int tableSize);
+  static void createSawtoothTable (MipmappedWavetable& waveTable, int tableSize);
+  static void createTriangleTable (MipmappedWavetable& waveTable, int tableSize);
+
+  /// Size of the bank's wavetables.
+  const int tableSize;
+
+  std::array<MipmappedWavetable, NumWaveforms> tables;
+};
+
+/// WavetableBuilder builds WavetableBanks on a background thread pool, one
+/// job per waveform so all the tables of a bank are built (or loaded from
+/// the WavetableCache) in parallel. The finished bank is published to the
+/// audio thread through an AtomicSnapshot. The pool is only started by the
+/// first request, so a builder that is never asked for tables has no
+/// threads.
+class WavetableBuilder
+{
+public:
+  WavetableBuilder() = default;
+
+  /// Waits for any running build to finish.
+  ~WavetableBuilder();
+
+  /// Starts building a bank with tables of tableSize samples. Does nothing
+  /// if that size was already requested. Call from the message thread (or
+  /// any single non-audio thread).
+  void requestBuild (int tableSize);
+
+  /// Waits until the most recently requested bank has been published, or
+  /// for at most timeoutMilliseconds (-1 waits forever). Returns true if it
+  /// was published. For offline rendering, which cannot start until the
+  /// tables exist.
+  bool waitForBuild (int timeoutMilliseconds = -1) const { return built.wait (timeoutMilliseconds); }
+
+  /// Called on the audio thread at the start of a block. Returns the newest
+  /// finished bank, or nullptr if none has finished yet.
+  const WavetableBank* acquireBank() noexcept { return banks.acquire(); }
+
+  /// Deletes the banks the audio thread has replaced. Call from the message
+  /// thread.
+  void collectGarbage() { banks.collectGarbage(); }
+
+private:
+  struct Build;
+
+  std::unique_ptr<ThreadPool> pool;
+  WavetableCache cache;
+  AtomicSnapshot<WavetableBank> banks;
+  /// The most recently requested table size and its request number. A build
+  /// that finishes after a newer request is discarded.
+  int requestedTableSize = 0;
+  std::atomic<int> generation {0};
+  /// Signalled when the bank of the latest request is published.
+  WaitableEvent built {true};
+
+  JUCE_DECLARE_NON_COPYABLE (WavetableBuilder)
+};
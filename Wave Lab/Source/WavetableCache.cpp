@@ -0,0 +1,78 @@
+//==============================================================================
+// WavetableCache.cpp
+//==============================================================================
+
+#include "WavetableCache.h"
+
+static const char cacheMagic[8] = {'W', 'L', 'T', 'A', 'B', 'L', 'E', 0};
+static const uint32 cacheFormatVersion = 2;
+static const uint32 cacheByteOrder = 0x01020304;
+
+WavetableCache::WavetableCache (const File& cacheDirectory)
+: directory (cacheDirectory) {
+   static_assert (sizeof(Header) == 64, "the samples must follow the header aligned");
+}
+
+File WavetableCache::getDefaultDirectory() {
+   return File::getSpecialLocation(File::userApplicationDataDirectory)
+   .getChildFile("Wave Lab")
+   .getChildFile("Wavetables");
+}
+
+File WavetableCache::getFile (int waveform, int tableSize) const {
+   return directory.getChildFile("wavetable-" + String(waveform) + "-" + String(tableSize) + ".bin");
+}
+
+WavetableCache::Header WavetableCache::makeHeader (int waveform, int tableSize, int numLevels,
+                                                   uint32 generatorVersion) {
+   Header header {};
+   std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+   header.formatVersion = cacheFormatVersion;
+   header.generatorVersion = generatorVersion;
+   header.waveform = (uint32) waveform;
+   header.tableSize = (uint32) tableSize;
+   header.numLevels = (uint32) numLevels;
+   header.byteOrder = cacheByteOrder;
+   return header;
+}
+
+bool WavetableCache::load (MipmappedWavetable& table, int waveform, int tableSize, int numLevels,
+                           uint32 generatorVersion) const {
+   auto file = getFile(waveform, tableSize);
+   if (! file.existsAsFile()) {
+      return false;
+   }
+   auto mapped = std::make_unique<MemoryMappedFile>(file, MemoryMappedFile::readOnly, false);
+   auto expected = makeHeader(waveform, tableSize, numLevels, generatorVersion);
+   auto numBytes = sizeof(Header) + sizeof(float) * (size_t) numLevels
+                   * (size_t) MipmappedWavetable::getLevelStride(tableSize);
+   if (mapped->getData() == nullptr || mapped->getSize() != numBytes
+       || std::memcmp(mapped->getData(), &expected, sizeof(Header)) != 0) {
+      return false;
+   }
+   auto* samples = reinterpret_cast<const float*>(static_cast<const char*>(mapped->getData()) + sizeof(Header));
+   table.referToMappedFile(std::move(mapped), samples, tableSize, numLevels);
+   return true;
+}
+
+bool WavetableCache::save (const MipmappedWavetable& table, int waveform, uint32 generatorVersion) const {
+   auto file = getFile(waveform, table.getTableSize());
+   if (directory.createDirectory().failed()) {
+      return false;
+   }
+   // write to a temporary file and move it over the old one, so a reader
+   // never maps a partially written file.
+   TemporaryFile temp (file);
+   {
+      FileOutputStream out (temp.getFile());
+      if (! out.openedOk()) {
+         return false;
+      }
+      auto header = makeHeader(waveform, table.getTableSize(), table.getNumLevels(), generatorVersion);
+      if (! out.write(&header, sizeof(header))
+          || ! out.write(table.getData(), sizeof(float) * (size_t) table.getNumSamples())) {
+         return false;
+      }
+   }
+   return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,59 @@
+//==============================================================================
+// WavetableCache.h
+// This file defines an on-disk cache of prebuilt wavetables.
+//==============================================================================
+
+#pragma once
+
+#include "MipmappedWavetable.h"
+
+/// WavetableCache stores each built MipmappedWavetable in its own binary
+/// file, named by the waveform and table size, so identical tables are not
+/// rebuilt on every launch. A cached table is loaded through a read-only
+/// MemoryMappedFile and the oscillators read the mapped samples directly,
+/// so loading only touches pages and copies nothing. Each file starts with
+/// a header recording the file format, the generator version, the waveform,
+/// the table size and number of levels. A file whose header does not match
+/// what is asked for is stale and is rebuilt and replaced.
+/// The tables do not depend on the sample rate (oscillators pick a band
+/// limited level from their table increment) so it is not part of the key.
+/// Loading and saving may be done on any thread.
+class WavetableCache
+{
+public:
+  /// Creates a cache in directory, by default the "Wave Lab/Wavetables"
+  /// folder in the user's application data directory.
+  explicit WavetableCache (const File& directory = getDefaultDirectory());
+
+  static File getDefaultDirectory();
+
+  /// Maps the cached table for waveform into table. Returns false, leaving
+  /// table unchanged, if there is no file or it does not match
+  /// generatorVersion, tableSize and numLevels.
+  bool load (MipmappedWavetable& table, int waveform, int tableSize, int numLevels,
+             uint32 generatorVersion) const;
+
+  /// Writes table to the cache file for waveform, replacing any old file.
+  /// Returns false if the file could not be written.
+  bool save (const MipmappedWavetable& table, int waveform, uint32 generatorVersion) const;
+
+  /// Returns the cache file for waveform and tableSize.
+  File getFile (int waveform, int tableSize) const;
+
+private:
+  /// The file header. It fills a cache line, so the samples following it
+  /// are aligned like those of a table allocated by setSize().
+  struct Header
+  {
+    char magic[8];
+    uint32 formatVersion, generatorVersion;
+    uint32 waveform, tableSize, numLevels;
+    /// Holds 0x01020304 in the byte order of the machine that wrote it.
+    uint32 byteOrder;
+    uint32 reserved[8];
+  };
+
+  static Header makeHeader (int waveform, int tableSize, int numLevels, uint32 generatorVersion);
+
+  File directory;
+};
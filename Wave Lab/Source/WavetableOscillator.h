@@ -7,24 +7,70 @@
 
 #pragma once
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include "EngineHeader.h"
+#include "MipmappedWavetable.h"
+#include "PhaseAccumulator.h"
+#include "WindowedSincKernel.h"
 
 /// WavetableOscillator contains one period of a sampled waveform defined over
-/// the number of samples in the table. The ending sample is set to be the same
-/// as the starting sample.
+/// the number of samples in the table. Each table is padded on both sides
+/// with guard samples that continue the period, so the sample after the last
+/// one is the first again. The waveform is stored at several band limited
+/// levels (see MipmappedWavetable) and the oscillator reads the level that
+/// does not alias at its current frequency. With crossfading enabled it blends
+/// that level with the next duller one across each octave so that sweeping
+/// the frequency does not produce audible steps in brightness. The oscillator
+/// does not own its wavetable, which can be replaced by setWavetable() on the
+/// thread that calls getNextSample().
+/// Samples between table entries are interpolated linearly, with a 4 point
+/// cubic (Hermite or Lagrange) or with an 8 tap windowed sinc. The higher
+/// orders read a few samples on either side of the index from the table's
+/// guard samples, so no interpolator has to wrap its indices. The
+/// interpolation can also be chosen at compile time with renderBlock<I>(),
+/// which leaves no interpolation branch in the loop.
+/// The position in the period is a PhaseAccumulator, so the table size must
+/// be a power of two: the index is the top bits of the phase, the fraction
+/// the bits below them, and the phase wraps by integer overflow.
 
 class WavetableOscillator
 {
 public:
-  WavetableOscillator (const AudioSampleBuffer& wavetableToUse)
-  : wavetable (wavetableToUse),
-  tableSize (wavetable.getNumSamples() - 1)
+  /// The ways of interpolating between table entries, from the cheapest to
+  /// the most accurate. Each is more accurate than the one before at every
+  /// frequency, most of all on the harmonics near the table's Nyquist
+  /// frequency, until they reach float precision.
+  enum Interpolation { Linear, CubicHermite, Lagrange, WindowedSinc };
+
+  WavetableOscillator() = default;
+
+  WavetableOscillator (const MipmappedWavetable& wavetableToUse)
   {
-    jassert (wavetable.getNumChannels() == 1);
+    setWavetable (&wavetableToUse);
   }
-  
-  void setFrequency (float frequency, float sampleRate)
+
+  /// Sets the wavetable to read from, keeping the current frequency and
+  /// relative position in the period. Does nothing if the table is unchanged.
+  void setWavetable (const MipmappedWavetable* wavetableToUse)
   {
+    if (wavetableToUse == wavetable)
+      return;
+    jassert (wavetableToUse == nullptr || wavetableToUse->getNumLevels() > 0);
+    // the phase is a fraction of the period, so it carries over as it is
+    wavetable = wavetableToUse;
+    tableSize = (wavetable != nullptr) ? wavetable->getTableSize() : 0;
+    indexBits = (wavetable != nullptr) ? PhaseAccumulator::getIndexBits (tableSize) : 0;
+    setFrequency (frequency, sampleRate);
+  }
+
+  bool hasWavetable() const noexcept { return wavetable != nullptr; }
+
+  void setFrequency (float newFrequency, float newSampleRate)
+  {
+    frequency = newFrequency;
+    sampleRate = newSampleRate;
+    phase.setFrequency (frequency, sampleRate);
+    if (wavetable == nullptr || sampleRate <= 0.0f)
+      return;
     /// For a one hertz tone we have to move over tableSize samples in one second. Since
     /// there are sampleRate samples per second, the table increment per sample would be
     /// tablesize/srate. For a two hertz tone we would have to move twice as fast, or
@@ -33,32 +79,231 @@ public:
     
     auto tableSizeOverSampleRate = tableSize / sampleRate;
     tableDelta = frequency * tableSizeOverSampleRate;
+
+    /// The level is the first octave above log2(tableDelta). When crossfading, the
+    /// position within that octave fades towards the next level.
+    auto level = wavetable->getLevelForDelta (tableDelta);
+    auto nextLevel = jmin (level + 1, wavetable->getNumLevels() - 1);
+    lowerTable = wavetable->getLevel (level);
+    upperTable = wavetable->getLevel (nextLevel);
+    upperGain = 0.0f;
+    if (crossfade && nextLevel != level && tableDelta > 0.0f) {
+      auto octave = std::log2 (tableDelta);
+      upperGain = jlimit (0.0f, 1.0f, octave - (float) (level - 1));
+    }
+  }
+
+  /// The position in the period, a fraction of 2^32. Table sample n is at
+  /// phase n * 2^32 / tableSize.
+  uint32 getPhase() const noexcept { return phase.getPhase(); }
+  void setPhase (uint32 newPhase) noexcept { phase.setPhase (newPhase); }
+
+  /// Sets the interpolation. Call it from the thread that renders or before
+  /// rendering starts.
+  void setInterpolation (Interpolation newInterpolation) noexcept
+  {
+    // builds the sinc kernel now rather than on the first rendered sample
+    if (newInterpolation == WindowedSinc)
+      WindowedSincKernel::get();
+    interpolation = newInterpolation;
   }
+
+  Interpolation getInterpolation() const noexcept { return interpolation; }
+
+  /// Enables or disables crossfading between adjacent levels. Takes effect
+  /// at the next setFrequency().
+  void setCrossfade (bool shouldCrossfade) noexcept { crossfade = shouldCrossfade; }
   
-  /// Uses linear interpolation to calculate the sample value for the (fractional) current index
-  /// and table increment
+  /// Overwrites numSamples of output with the oscillator's next samples scaled
+  /// by gain. The same as calling getNextSample() for every sample, but the
+  /// table positions, fractions and interpolation are computed for several
+  /// samples at once with SIMD registers. Only the table lookups are scalar.
+  /// The oscillator must have a wavetable.
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    switch (interpolation) {
+      case CubicHermite: renderBlock<CubicHermite> (output, numSamples, gain); break;
+      case Lagrange:     renderBlock<Lagrange> (output, numSamples, gain);     break;
+      case WindowedSinc: renderBlock<WindowedSinc> (output, numSamples, gain); break;
+      default:           renderBlock<Linear> (output, numSamples, gain);       break;
+    }
+  }
+
+  /// renderBlock() with the interpolation I rather than the one set by
+  /// setInterpolation().
+  template <Interpolation I>
+  void renderBlock (float* output, int numSamples, float gain) noexcept
+  {
+    // render up to the first aligned sample, the vector loop, then the remainder.
+    auto* alignedOutput = jmin (SIMDFloat::getNextSIMDAlignedPtr (output), output + numSamples);
+    auto numHead = (int) (alignedOutput - output);
+    renderScalar<I> (output, numHead, gain);
+    auto numVector = (numSamples - numHead) / numLanes * numLanes;
+    renderVector<I> (alignedOutput, numVector, gain);
+    renderScalar<I> (alignedOutput + numVector, numSamples - numHead - numVector, gain);
+  }
+
+  /// Interpolates the sample value at the current phase and advances the
+  /// phase by one sample. The oscillator must have a wavetable. This is the
+  /// reference for renderBlock().
   forcedinline float getNextSample() noexcept
   {
-    /// Get current integer index (index0) and next index (index1)
-    auto index0 = (unsigned int) currentIndex;
-    auto index1 = index0 + 1;
-    /// Calculate the difference between the floating point index (currentIndex) and the integer index
-    auto frac = currentIndex - (float) index0;
-    /// get the sample for the current index and for the next index
-    auto* table = wavetable.getReadPointer (0);
-    auto value0 = table[index0];
-    auto value1 = table[index1];
-    /// add to value 1 the proportional amount (frac) of the difference between the two samples.
-    auto currentSample = value0 + frac * (value1 - value0);
-    /// increment the currentIndex by the tableDelta (freq*sr/tableSize) and wrap if needed.
-    if ((currentIndex += tableDelta) > tableSize)
-      currentIndex -= tableSize;
-    
+    switch (interpolation) {
+      case CubicHermite: return getNextSample<CubicHermite>();
+      case Lagrange:     return getNextSample<Lagrange>();
+      case WindowedSinc: return getNextSample<WindowedSinc>();
+      default:           return getNextSample<Linear>();
+    }
+  }
+
+  /// getNextSample() with the interpolation I.
+  template <Interpolation I>
+  forcedinline float getNextSample() noexcept
+  {
+    // the integer index is the top indexBits of the phase and the fraction
+    // between it and the next index the bits below them
+    auto current = phase.advance();
+    auto index = PhaseAccumulator::getIndex (current, indexBits);
+    auto frac = PhaseAccumulator::getFraction (current, indexBits);
+    auto currentSample = interpolate<I> (lowerTable + index, frac);
+    // fade towards the same position in the next level
+    if (upperGain > 0.0f)
+      currentSample += upperGain * (interpolate<I> (upperTable + index, frac) - currentSample);
     return currentSample;
   }
   
 private:
-  const AudioSampleBuffer& wavetable;
-  const int tableSize;
-  float currentIndex = 0.0f, tableDelta = 0.0f;
+  using SIMDFloat = dsp::SIMDRegister<float>;
+  static constexpr int numLanes = (int) SIMDFloat::SIMDNumElements;
+
+  template <Interpolation I>
+  void renderScalar (float* output, int numSamples, float gain) noexcept
+  {
+    for (int i = 0; i < numSamples; ++i)
+      output[i] = getNextSample<I>() * gain;
+  }
+
+  /// Renders numSamples (a multiple of numLanes) to SIMD aligned output.
+  /// Each lane holds the phase of one of numLanes consecutive samples and
+  /// all lanes advance by numLanes increments per step, wrapping by
+  /// overflow. SIMDRegister has no shifts, so the indices and fractions are
+  /// split off in plain integer loops, which the compiler vectorizes.
+  template <Interpolation I>
+  void renderVector (float* output, int numSamples, float gain) noexcept
+  {
+    if (numSamples <= 0)
+      return;
+    alignas (SIMDFloat::SIMDRegisterSize) uint32 phases[numLanes];
+    alignas (SIMDFloat::SIMDRegisterSize) float fracs[numLanes];
+    alignas (SIMDFloat::SIMDRegisterSize) int indices[numLanes];
+    for (int lane = 0; lane < numLanes; ++lane)
+      phases[lane] = phase.getPhase() + (uint32) lane * phase.getIncrement();
+    const auto step = (uint32) numLanes * phase.getIncrement();
+    const auto gains = SIMDFloat::expand (gain);
+    const auto upperGains = SIMDFloat::expand (upperGain);
+    const auto fade = upperGain > 0.0f;
+
+    for (int i = 0; i < numSamples; i += numLanes) {
+      for (int lane = 0; lane < numLanes; ++lane) {
+        indices[lane] = PhaseAccumulator::getIndex (phases[lane], indexBits);
+        fracs[lane] = PhaseAccumulator::getFraction (phases[lane], indexBits);
+        phases[lane] += step;
+      }
+      auto frac = SIMDFloat::fromRawArray (fracs);
+      auto sample = interpolateLanes<I> (lowerTable, indices, frac);
+      if (fade)
+        sample += upperGains * (interpolateLanes<I> (upperTable, indices, frac) - sample);
+      (sample * gains).copyToRawArray (output + i);
+    }
+    phase.advance (numSamples);
+  }
+
+  /// Interpolates between table[0] and table[1]. The higher orders also
+  /// read the samples from table[-3] to table[4].
+  template <Interpolation I>
+  static forcedinline float interpolate (const float* table, float frac) noexcept
+  {
+    switch (I) {
+      case CubicHermite: return hermite (table[-1], table[0], table[1], table[2], frac);
+      case Lagrange:     return lagrange (table[-1], table[0], table[1], table[2], frac);
+      case WindowedSinc: return windowedSinc (table, frac);
+      default:           return table[0] + frac * (table[1] - table[0]);
+    }
+  }
+
+  /// Interpolates numLanes positions, given by their integer indices and
+  /// fractions, at once. The windowed sinc is computed one lane at a time.
+  template <Interpolation I>
+  static SIMDFloat interpolateLanes (const float* table, const int* indices, SIMDFloat frac) noexcept
+  {
+    alignas (SIMDFloat::SIMDRegisterSize) float taps[4][numLanes];
+    if (I == WindowedSinc) {
+      frac.copyToRawArray (taps[0]);
+      for (int lane = 0; lane < numLanes; ++lane)
+        taps[1][lane] = windowedSinc (table + indices[lane], taps[0][lane]);
+      return SIMDFloat::fromRawArray (taps[1]);
+    }
+    constexpr auto numTaps = (I == Linear) ? 2 : 4;
+    constexpr auto first = (I == Linear) ? 0 : -1;
+    for (int tap = 0; tap < numTaps; ++tap)
+      for (int lane = 0; lane < numLanes; ++lane)
+        taps[tap][lane] = table[indices[lane] + first + tap];
+    auto x0 = SIMDFloat::fromRawArray (taps[0]);
+    auto x1 = SIMDFloat::fromRawArray (taps[1]);
+    if (I == Linear)
+      return x0 + frac * (x1 - x0);
+    auto x2 = SIMDFloat::fromRawArray (taps[2]);
+    auto x3 = SIMDFloat::fromRawArray (taps[3]);
+    return (I == CubicHermite) ? hermite (x0, x1, x2, x3, frac)
+                                           : lagrange (x0, x1, x2, x3, frac);
+  }
+
+  /// The Catmull-Rom cubic Hermite spline through x0 and x1, with the slopes
+  /// at x0 and x1 estimated from their neighbours. Written for both float
+  /// and SIMDFloat.
+  template <typename Type>
+  static Type hermite (Type xm1, Type x0, Type x1, Type x2, Type t) noexcept
+  {
+    auto c1 = (x1 - xm1) * 0.5f;
+    auto c2 = xm1 - x0 * 2.5f + x1 * 2.0f - x2 * 0.5f;
+    auto c3 = (x2 - xm1) * 0.5f + (x0 - x1) * 1.5f;
+    return ((c3 * t + c2) * t + c1) * t + x0;
+  }
+
+  /// The cubic Lagrange polynomial through all four points.
+  template <typename Type>
+  static Type lagrange (Type xm1, Type x0, Type x1, Type x2, Type t) noexcept
+  {
+    auto c1 = x1 - x2 * (1.0f / 6.0f) - x0 * 0.5f - xm1 * (1.0f / 3.0f);
+    auto c2 = (xm1 + x1) * 0.5f - x0;
+    auto c3 = (x2 - xm1) * (1.0f / 6.0f) + (x0 - x1) * 0.5f;
+    return ((c3 * t + c2) * t + c1) * t + x0;
+  }
+
+  /// Interpolates with the windowed sinc kernel, reading table[-3] to table[4].
+  static float windowedSinc (const float* table, float frac) noexcept
+  {
+    // summed in double, or the rounding of the 8 products would be larger
+    // than the kernel's own error
+    auto sample = 0.0;
+    WindowedSincKernel::get().forEachTap (frac, [&] (int tap, float coefficient)
+    {
+      sample += (double) table[tap - 3] * coefficient;
+    });
+    return (float) sample;
+  }
+
+  const MipmappedWavetable* wavetable = nullptr;
+  int tableSize = 0, indexBits = 0;
+  /// The position in the period. tableDelta is its increment in table
+  /// samples, which selects the level.
+  PhaseAccumulator phase;
+  float tableDelta = 0.0f;
+  float frequency = 0.0f, sampleRate = 0.0f;
+  /// The level being played, the next duller level and the amount of it to mix in.
+  const float* lowerTable = nullptr;
+  const float* upperTable = nullptr;
+  float upperGain = 0.0f;
+  bool crossfade = true;
+  Interpolation interpolation = Linear;
 };
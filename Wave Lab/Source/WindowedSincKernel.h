@@ -0,0 +1,109 @@
+
+//==============================================================================
+// WindowedSincKernel.h
+// A tabulated windowed sinc for fractional delays.
+//==============================================================================
+
+#pragma once
+
+#include "EngineHeader.h"
+
+/// WindowedSincKernel holds the coefficients of an 8 tap Blackman windowed
+/// sinc at numPhases + 1 evenly spaced fractions from 0 to 1. Tap k of the
+/// row for fraction f is the kernel at a distance of (k - 3) - f samples,
+/// so it interpolates a signal at 3 + f samples from the first tap or,
+/// turned around, spreads a band limited impulse at that position over the
+/// 8 taps. The window alone droops in the passband, which on a slowly
+/// changing signal makes the kernel less accurate than a 4 point Lagrange
+/// interpolator. Each row is therefore corrected, by as little as possible,
+/// so that it interpolates any cubic exactly, as Lagrange does, while the
+/// sinc keeps it more accurate near the Nyquist frequency. A constant
+/// signal passes unchanged. The single instance is built the first time
+/// get() is called, which should not be on the audio thread.
+
+class WindowedSincKernel
+{
+public:
+  static constexpr int numTaps = 8, numPhases = 256;
+
+  static const WindowedSincKernel& get()
+  {
+    static const WindowedSincKernel kernel;
+    return kernel;
+  }
+
+  /// Calls function (tap, coefficient) for every tap of the kernel for frac
+  /// in [0, 1), linearly interpolated between the two nearest rows.
+  template <typename Function>
+  forcedinline void forEachTap (float frac, Function&& function) const noexcept
+  {
+    auto position = frac * (float) numPhases;
+    auto phase = jmin ((int) position, numPhases - 1);
+    auto t = position - (float) phase;
+    auto* row0 = coefficients.data() + phase * numTaps;
+    auto* row1 = row0 + numTaps;
+    for (int tap = 0; tap < numTaps; ++tap)
+      function (tap, row0[tap] + t * (row1[tap] - row0[tap]));
+  }
+
+private:
+  WindowedSincKernel()
+  {
+    auto halfWidth = 0.5 * numTaps;
+    for (int phase = 0; phase <= numPhases; ++phase) {
+      auto* row = coefficients.data() + phase * numTaps;
+      double distances[numTaps], values[numTaps];
+      for (int tap = 0; tap < numTaps; ++tap) {
+        auto x = (double) (tap - 3) - (double) phase / numPhases;
+        auto sinc = (x == 0.0) ? 1.0 : std::sin (MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+        auto w = MathConstants<double>::pi * x / halfWidth;
+        auto window = 0.42 + 0.5 * std::cos (w) + 0.08 * std::cos (2.0 * w);
+        distances[tap] = x;
+        values[tap] = sinc * window;
+      }
+      reproduceCubics (distances, values);
+      for (int tap = 0; tap < numTaps; ++tap)
+        row[tap] = (float) values[tap];
+    }
+  }
+
+  /// Adds the smallest correction (in the least squares sense) to the taps
+  /// at distances that makes the sum of values[k] * distances[k]^m 1 for
+  /// m = 0 and 0 for m = 1 to 3, so the taps interpolate a cubic exactly.
+  /// The correction is a cubic in the distance whose coefficients solve the
+  /// normal equations, which are positive definite and need no pivoting.
+  static void reproduceCubics (const double* distances, double* values) noexcept
+  {
+    constexpr int numMoments = 4;
+    double equations[numMoments][numMoments + 1] = {};
+    for (int tap = 0; tap < numTaps; ++tap) {
+      double powers[2 * numMoments - 1] = {1.0};
+      for (int m = 1; m < 2 * numMoments - 1; ++m)
+        powers[m] = powers[m - 1] * distances[tap];
+      for (int m = 0; m < numMoments; ++m) {
+        for (int j = 0; j < numMoments; ++j)
+          equations[m][j] += powers[m + j];
+        equations[m][numMoments] -= values[tap] * powers[m];
+      }
+    }
+    equations[0][numMoments] += 1.0;
+    for (int m = 0; m < numMoments; ++m) {
+      for (int other = 0; other < numMoments; ++other) {
+        if (other == m)
+          continue;
+        auto factor = equations[other][m] / equations[m][m];
+        for (int j = m; j <= numMoments; ++j)
+          equations[other][j] -= factor * equations[m][j];
+      }
+    }
+    for (int tap = 0; tap < numTaps; ++tap) {
+      auto power = 1.0;
+      for (int m = 0; m < numMoments; ++m) {
+        values[tap] += power * equations[m][numMoments] / equations[m][m];
+        power *= distances[tap];
+      }
+    }
+  }
+
+  std::array<float, (numPhases + 1) * numTaps> coefficients;
+};